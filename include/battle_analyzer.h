@@ -0,0 +1,46 @@
+#ifndef BATTLE_ANALYZER_H
+#define BATTLE_ANALYZER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "npc.h"
+
+class CompactNPCStore;
+
+struct BattleOutcome{
+    double range = 0.0;
+    size_t pairCount = 0;
+    size_t squirrels = 0;
+    size_t werewolves = 0;
+    size_t druids = 0;
+    std::vector<std::string> killed;
+    size_t survivors() const { return squirrels + werewolves + druids; }
+};
+
+// Predicts BattleVisitor::executeBattle for many ranges without touching the
+// NPCs. Kills do not depend on the order pairs are resolved in, so each NPC
+// dies exactly when the range reaches its closest lethal pair; one pair search
+// up to the largest range answers every smaller range.
+class BattleAnalyzer{
+private:
+    enum class Kind{ SQUIRREL, WEREWOLF, DRUID };
+    struct Entry{
+        std::string name;
+        Kind kind;
+        double deathRange;
+    };
+    std::vector<Entry> entries;
+    std::vector<double> pairDistances;
+
+public:
+    BattleAnalyzer(const std::vector<std::shared_ptr<NPC>>& npcs, double maxRange);
+    // Reads the packed arrays directly; same result as on store.materialize().
+    BattleAnalyzer(const CompactNPCStore& store, double maxRange);
+    BattleOutcome evaluate(double range) const;
+    std::vector<BattleOutcome> evaluate(const std::vector<double>& ranges) const;
+    static std::vector<BattleOutcome> analyze(const std::vector<std::shared_ptr<NPC>>& npcs, const std::vector<double>& ranges);
+    static std::vector<BattleOutcome> analyze(const CompactNPCStore& store, const std::vector<double>& ranges);
+};
+
+#endif
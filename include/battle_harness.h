@@ -0,0 +1,66 @@
+#ifndef BATTLE_HARNESS_H
+#define BATTLE_HARNESS_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "workload.h"
+
+class NPC;
+
+struct BattleRun{
+    std::vector<std::string> survivors;
+    std::vector<std::string> events;
+    double seconds = 0.0;
+};
+
+struct BattleEngine{
+    std::string name;
+    // false: survivors and events are compared as multisets.
+    bool ordered = true;
+    bool reportsEvents = true;
+    std::function<BattleRun(const std::vector<NPCSpec>&, double)> run;
+    // > 0: lossy engine whose distances may be off by up to this much. Its
+    // kills and events must lie between the reference at range - tolerance
+    // and at range + tolerance (compared as multisets).
+    double tolerance = 0.0;
+};
+
+struct EngineComparison{
+    std::string name;
+    bool survivorsMatch = false;
+    bool eventsMatch = false;
+    double seconds = 0.0;
+    double speedup = 0.0;
+    double tolerance = 0.0;
+    // Survivors present in only one of the engine and the exact reference.
+    size_t survivorsDiffering = 0;
+    std::string mismatch;
+    bool matches() const { return survivorsMatch && eventsMatch; }
+};
+
+// Differential checks of every battle engine against the sequential
+// all-pairs BattleVisitor::executeBattle on the same dungeon.
+class BattleHarness{
+public:
+    // Seeded dungeon with the generator's raw coordinates, as production
+    // sees them.
+    static std::vector<NPCSpec> generate(const WorkloadGenerator::Config& config);
+    // Coordinates snapped to the compact store's fixed point grid, where the
+    // compact engine is exact.
+    static std::vector<NPCSpec> snapToCompactGrid(std::vector<NPCSpec> specs);
+    // Bound on the compact store's distance error: snapping moves each
+    // coordinate by at most one step, a distance by at most 2*sqrt(2) < 3 steps.
+    static double compactTolerance();
+    // Fresh NPC objects for the specs, in spec order.
+    static std::vector<std::shared_ptr<NPC>> buildNPCs(const std::vector<NPCSpec>& specs);
+    static BattleRun runReference(const std::vector<NPCSpec>& specs, double range);
+    static std::vector<BattleEngine> defaultEngines(size_t threads = 0);
+    static std::vector<EngineComparison> compare(const std::vector<NPCSpec>& specs, double range,
+                                                 const std::vector<BattleEngine>& engines);
+    static std::vector<EngineComparison> compare(const BattleRun& reference, const std::vector<NPCSpec>& specs,
+                                                 double range, const std::vector<BattleEngine>& engines);
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef COMPACT_STORE_H
+#define COMPACT_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc.h"
+#include "npc_factory.h"
+
+class BattleLogger;
+
+// Struct-of-arrays NPC storage: 16-bit fixed point coordinates over (0, 500],
+// 2-bit type tags packed four per byte and all names in one character arena.
+// Roughly 8 bytes plus the name per NPC instead of a heap object per NPC.
+class CompactNPCStore{
+private:
+    std::vector<uint16_t> xs;
+    std::vector<uint16_t> ys;
+    std::vector<uint8_t> typeTags;
+    std::vector<char> nameArena;
+    std::vector<uint32_t> nameOffsets{0};
+
+    void setTypeTag(size_t index, NPCFactory::NPCType type);
+    void removeDead(const std::vector<uint8_t>& alive);
+
+public:
+    struct MemoryUsage{
+        size_t coordinates = 0;
+        size_t typeTags = 0;
+        size_t names = 0;
+    };
+
+    static constexpr double kMaxCoordinate = 500.0;
+    static constexpr double kStep = kMaxCoordinate / 65536.0;
+
+    static uint16_t encodeCoordinate(double value);
+    static double decodeCoordinate(uint16_t code);
+    static bool canAttack(NPCFactory::NPCType attacker, NPCFactory::NPCType target);
+    static std::string typeName(NPCFactory::NPCType type);
+
+    bool add(NPCFactory::NPCType type, const std::string& name, double x, double y);
+    bool contains(std::string_view name) const;
+    size_t size() const;
+    bool empty() const;
+    void clear();
+    void reserve(size_t count, size_t nameBytes = 0);
+    void shrinkToFit();
+
+    NPCFactory::NPCType getType(size_t index) const;
+    std::string_view getName(size_t index) const;
+    double getX(size_t index) const;
+    double getY(size_t index) const;
+
+    void assign(const std::vector<std::shared_ptr<NPC>>& npcs);
+    std::vector<std::shared_ptr<NPC>> materialize() const;
+    void executeBattle(double range, BattleLogger* logger = nullptr);
+    bool saveToFile(const std::string& filename, bool verbose = true) const;
+    bool loadFromFile(const std::string& filename, bool verbose = true);
+    // Same files as NPCFactory::saveToFileSharded, formatted straight from
+    // the packed arrays.
+    bool saveToFileSharded(const std::string& manifestFilename, size_t shardCount = 0, bool verbose = true) const;
+    MemoryUsage memoryUsage() const;
+};
+
+#endif
@@ -3,24 +3,75 @@
 
 #include <vector>
 #include <memory>
+#include <optional>
+#include <string>
 #include "npc.h"
+#include "npc_factory.h"
 #include "observer.h"
+#include "compact_store.h"
+#include "battle_analyzer.h"
+#include "shm_feed.h"
+
+// Filters and paging for DungeonEditor listings. The region is inclusive.
+struct NPCListOptions{
+    size_t offset = 0;
+    size_t limit = SIZE_MAX;
+    std::optional<NPCFactory::NPCType> type;
+    std::optional<bool> alive;
+    double minX = 0.0;
+    double minY = 0.0;
+    double maxX = 500.0;
+    double maxY = 500.0;
+};
 
 class DungeonEditor{
+    friend class TiledWorld;
 private:
     std::vector<std::shared_ptr<NPC>> npcs;
     BattleLogger battleLogger;
+    bool compactMode = false;
+    CompactNPCStore compactStore;
+    size_t battleThreads = 1;
+    std::unique_ptr<SharedMemoryLogger> sharedMemoryLogger;
+    bool quiet = false;
 public:
+    // Estimated heap bytes per subsystem. In compact mode npcObjects holds the
+    // packed coordinate and type arrays and names the name arena.
+    struct MemoryUsage{
+        size_t npcObjects = 0;
+        size_t names = 0;
+        size_t indexes = 0;
+        size_t loggers = 0;
+        size_t total() const { return npcObjects + names + indexes + loggers; }
+    };
+
     DungeonEditor();
     bool addNPC(const std::string& type, const std::string& name, double x, double y);
     void printAllNPCs() const;
+    void printNPCs(const NPCListOptions& options) const;
+    // The listing printed by printNPCs, built in one buffer.
+    std::string renderNPCTable(const NPCListOptions& options = NPCListOptions()) const;
     void startBattle(double range);
+    std::vector<BattleOutcome> analyzeBattle(const std::vector<double>& ranges) const;
     bool saveToFile(const std::string& filename) const;
     bool loadFromFile(const std::string& filename);
+    bool saveToFileSharded(const std::string& manifestFilename, size_t shardCount = 0) const;
+    bool loadFromFileSharded(const std::string& manifestFilename);
     void attachConsoleLogger();
     void attachFileLogger(const std::string& filename = "log.txt");
+    bool attachSharedMemoryLogger(const std::string& name = "/npc_battle_feed");
     size_t getNPCCount() const;
+    std::vector<std::string> getNPCNames() const;
     void clearAll();
+    MemoryUsage getMemoryUsage() const;
+    void setCompactMode(bool enabled);
+    bool isCompactMode() const;
+    // 1 keeps the sequential battle, 0 uses one thread per hardware thread.
+    void setBattleThreads(size_t threads);
+    // Quiet mode drops status lines and the console battle log; errors still
+    // go to std::cerr and explicit listings are still printed.
+    void setQuiet(bool enabled);
+    bool isQuiet() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,6 +1,8 @@
 #ifndef NPC_FACTORY_H
 #define NPC_FACTORY_H
 
+#include <functional>
+#include <iosfwd>
 #include <memory>
 #include <string>
 #include <vector>
@@ -14,8 +16,16 @@ public:
         DRUID
     };
     static std::shared_ptr<NPC> createNPC(NPCType type, const std::string& name, double x, double y);
-    static bool saveToFile(const std::vector<std::shared_ptr<NPC>>& npcs, const std::string& filename);
-    static std::vector<std::shared_ptr<NPC>> loadFromFile(const std::string& filename);
+    static bool saveToFile(const std::vector<std::shared_ptr<NPC>>& npcs, const std::string& filename, bool verbose = true);
+    static std::vector<std::shared_ptr<NPC>> loadFromFile(const std::string& filename, bool verbose = true);
+    // Manifest plus one file per shard, each written or parsed on its own thread.
+    // shardCount == 0 uses one shard per hardware thread.
+    static bool saveToFileSharded(const std::vector<std::shared_ptr<NPC>>& npcs, const std::string& manifestFilename, size_t shardCount = 0, bool verbose = true);
+    static std::vector<std::shared_ptr<NPC>> loadFromFileSharded(const std::string& manifestFilename, bool verbose = true);
+    // The sharded writer for any row source: writeRow(out, i) formats row i
+    // (or nothing), and is called concurrently for different rows.
+    static bool saveRowsSharded(size_t rowCount, const std::function<void(std::ostream&, size_t)>& writeRow,
+                                const std::string& manifestFilename, size_t shardCount = 0, bool verbose = true);
     static NPCType stringToType(const std::string& typeStr);
     static std::string typeToString(NPCType type);
 };
@@ -12,12 +12,14 @@ public:
     void attach(BattleObserver * observer);
     void detach(BattleObserver * observer);
     void notify(const std::string &event);
+    size_t memoryUsage() const;
 };
 
 class BattleObserver {
 public:
     virtual ~BattleObserver() = default;
     virtual void update(const std::string &event) = 0;
+    virtual size_t memoryUsage() const { return 0; }
 };
 
 class ConsoleLogger : public BattleObserver {
@@ -32,6 +34,7 @@ private:
 public:
     FileLogger(const std::string &filename = "log.txt");
     void update(const std::string &event) override;
+    size_t memoryUsage() const override;
 };
 
 class BattleLogger : public BattleSubject {
@@ -0,0 +1,65 @@
+#ifndef SHM_FEED_H
+#define SHM_FEED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "observer.h"
+
+struct ShmFeedHeader;
+
+// Publishes battle events into a POSIX shared-memory ring. Each slot carries
+// the sequence number of the event in it; the writer never waits for readers,
+// so a slow reader loses the oldest events instead of slowing notify().
+// One writer per ring; any number of readers. The ring is created
+// exclusively: if the name is taken by a live writer the logger stays closed,
+// a ring whose writer process has died is replaced.
+class SharedMemoryLogger : public BattleObserver {
+private:
+    std::string name;
+    ShmFeedHeader* header = nullptr;
+    size_t mappedBytes = 0;
+    uint32_t slotCount = 0;
+    uint32_t slotSize = 0;
+public:
+    SharedMemoryLogger(const std::string &name = "/npc_battle_feed", uint32_t slotCount = 4096, uint32_t slotSize = 256);
+    ~SharedMemoryLogger() override;
+    SharedMemoryLogger(const SharedMemoryLogger&) = delete;
+    SharedMemoryLogger& operator=(const SharedMemoryLogger&) = delete;
+    bool isOpen() const;
+    void update(const std::string &event) override;
+    uint64_t getSequence() const;
+    size_t memoryUsage() const override;
+};
+
+struct FeedEvent{
+    uint64_t sequence;
+    int64_t timestampNs;
+    std::string text;
+};
+
+// Lock-free consumer: poll() only reads shared memory, no locks or syscalls.
+// The ring geometry is read once at open and never trusted again.
+class SharedMemoryFeedReader {
+private:
+    const ShmFeedHeader* header = nullptr;
+    size_t mappedBytes = 0;
+    uint32_t slotCount = 0;
+    uint32_t slotSize = 0;
+    uint64_t nextSequence = 1;
+public:
+    // fromOldest starts at the oldest event still in the ring, otherwise only
+    // events published after the reader was opened are returned.
+    explicit SharedMemoryFeedReader(const std::string &name = "/npc_battle_feed", bool fromOldest = true);
+    ~SharedMemoryFeedReader();
+    SharedMemoryFeedReader(const SharedMemoryFeedReader&) = delete;
+    SharedMemoryFeedReader& operator=(const SharedMemoryFeedReader&) = delete;
+    bool isOpen() const;
+    // Appends up to maxEvents new events; returns how many were overwritten
+    // before they could be read.
+    size_t poll(std::vector<FeedEvent> &events, size_t maxEvents = SIZE_MAX);
+    uint64_t getNextSequence() const;
+};
+
+#endif
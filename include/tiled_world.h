@@ -0,0 +1,82 @@
+#ifndef TILED_WORLD_H
+#define TILED_WORLD_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "dungeon_editor.h"
+#include "observer.h"
+
+// A world of tilesX x tilesY map tiles, each the size of one dungeon. Every
+// tile lives in its own snapshot file under `directory` and is memory-mapped
+// into a DungeonEditor only while it is needed; at most maxResidentTiles stay
+// loaded, the least recently used one is written back and dropped.
+// Global coordinates run over (0, tilesX * 500] x (0, tilesY * 500].
+class TiledWorld{
+public:
+    static constexpr double kTileSize = 500.0;
+    using TileCoord = std::pair<size_t, size_t>;
+
+    TiledWorld(const std::string& directory, size_t tilesX, size_t tilesY, size_t maxResidentTiles = 9);
+    ~TiledWorld();
+    TiledWorld(const TiledWorld&) = delete;
+    TiledWorld& operator=(const TiledWorld&) = delete;
+
+    bool addNPC(const std::string& type, const std::string& name, double x, double y);
+    // The editor of one tile, in tile-local coordinates. Valid until the next
+    // call that loads another tile.
+    DungeonEditor& tile(size_t tx, size_t ty);
+    // Battles every pair with at least one NPC in an active tile, including
+    // pairs across tile borders, with the same outcome as one battle over the
+    // whole area. Returns the number of NPCs killed.
+    size_t startBattle(double range);
+    size_t startBattle(double range, const std::vector<TileCoord>& activeTiles);
+    // Writes every resident tile back. A tile whose snapshot could not be
+    // read is loaded empty and left untouched on disk.
+    bool flush();
+
+    size_t getNPCCount() const;
+    size_t getTileNPCCount(size_t tx, size_t ty) const;
+    size_t getResidentTileCount() const;
+    size_t getTilesX() const;
+    size_t getTilesY() const;
+    BattleLogger& getBattleLogger();
+
+private:
+    struct ResidentTile{
+        std::unique_ptr<DungeonEditor> editor;
+        std::list<size_t>::iterator lruPosition;
+    };
+    struct BattleEntry{
+        std::shared_ptr<NPC> npc;
+        size_t tileKey;
+        size_t index;
+    };
+
+    std::string directory;
+    size_t tilesX;
+    size_t tilesY;
+    size_t maxResidentTiles;
+    std::vector<uint32_t> tileCounts;
+    // Tiles whose snapshot failed to decode; never written back.
+    std::unordered_set<size_t> damagedTiles;
+    std::unordered_map<size_t, ResidentTile> resident;
+    std::list<size_t> lru;
+    BattleLogger battleLogger;
+
+    size_t keyOf(size_t tx, size_t ty) const;
+    std::string tilePath(size_t key) const;
+    DungeonEditor& load(size_t key);
+    bool evict(size_t key);
+    bool saveTile(size_t key, const DungeonEditor& editor) const;
+    bool writeSnapshot(size_t key, const DungeonEditor& editor) const;
+    bool readSnapshot(size_t key, DungeonEditor& editor) const;
+    std::vector<BattleEntry> collect(size_t key, double range, size_t ownerKey);
+};
+
+#endif
@@ -3,12 +3,20 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
 
 class NPC;
 class Squirrel;
 class Werewolf;
 class Druid;
 
+// Text of the battle event logged for a pair, or "" if neither side can
+// attack. Shared by every battle engine so their logs stay identical.
+std::string battleEventText(std::string_view name1, std::string_view type1,
+                            std::string_view name2, std::string_view type2, bool npc1Can, bool npc2Can);
+
 class NPCVisitor{
 public:
     virtual ~NPCVisitor() = default;
@@ -29,9 +37,19 @@ public:
     void visit(Druid* druid) override;
     
     void executeBattle();
+    // Same kills and event order as executeBattle. Pairs are found and
+    // resolved on threadCount threads (0 = one per hardware thread); events
+    // are still delivered to the logger from the calling thread.
+    void executeBattleParallel(size_t threadCount = 0);
+    // Groups pair indices into batches in which no NPC appears twice. Each
+    // NPC's pairs land in increasing batches, preserving their relative order.
+    static std::vector<std::vector<size_t>> conflictFreeBatches(const std::vector<std::pair<NPC*, NPC*>>& pairs);
     
 private:
     void resolveBattle(NPC* attacker, NPC* target);
+    static std::string resolvePair(NPC* npc1, NPC* npc2);
+    std::vector<std::pair<NPC*, NPC*>> findPairs(size_t threadCount) const;
+    void removeDead();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "npc_factory.h"
+
+class DungeonEditor;
+
+struct NPCSpec{
+    NPCFactory::NPCType type;
+    std::string name;
+    double x;
+    double y;
+};
+
+class WorkloadGenerator{
+public:
+    enum class Distribution{
+        UNIFORM,
+        CLUSTERED,
+        HOTSPOT
+    };
+    struct Config{
+        size_t npcCount = 1000;
+        uint64_t seed = 1;
+        // Relative weights of each type, normalised by the generator.
+        double squirrelWeight = 1.0;
+        double werewolfWeight = 1.0;
+        double druidWeight = 1.0;
+        Distribution distribution = Distribution::UNIFORM;
+        // CLUSTERED: number of gaussian blobs and their standard deviation.
+        size_t clusterCount = 8;
+        double clusterSpread = 15.0;
+        // HOTSPOT: share of NPCs packed into one square of the given side.
+        double hotspotShare = 0.8;
+        double hotspotSize = 50.0;
+    };
+
+    explicit WorkloadGenerator(const Config& config);
+    std::vector<NPCSpec> generate() const;
+    size_t populate(DungeonEditor& editor) const;
+    static Distribution stringToDistribution(const std::string& str, bool* ok = nullptr);
+    static std::string distributionToString(Distribution distribution);
+
+private:
+    Config config;
+};
+
+#endif
@@ -1,9 +1,384 @@
-#include <iostream>
-#include <algorithm>
-#include <stdexcept>
-
-
-int main(){
-    return 0;
-}
-
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "include/dungeon_editor.h"
+#include "include/workload.h"
+#include "include/battle_harness.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options{
+    WorkloadGenerator::Config workload;
+    double range = 10.0;
+    std::string file = "workload_dungeon.txt";
+    std::string script = "add,save,clear,load,battle";
+    bool keepFile = false;
+    bool compact = false;
+    size_t shards = 0;
+    size_t battleThreads = 1;
+    std::string feed;
+    std::vector<double> analyzeRanges{1.0, 2.0, 5.0, 10.0, 20.0};
+};
+
+struct Step{
+    std::string op;
+    double range;
+};
+
+struct PhaseReport{
+    std::string name;
+    size_t items = 0;
+    double seconds = 0.0;
+    std::vector<double> latencies;
+    std::vector<std::string> notes;
+    bool failed = false;
+};
+
+void printUsage(const char* program){
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --npcs N              NPCs to generate (default 1000)\n"
+              << "  --seed S              generator seed (default 1)\n"
+              << "  --mix S:W:D           squirrel:werewolf:druid weights (default 1:1:1)\n"
+              << "  --distribution D      uniform | clustered | hotspot (default uniform)\n"
+              << "  --clusters K          cluster count for clustered (default 8)\n"
+              << "  --spread R            cluster standard deviation (default 15)\n"
+              << "  --hotspot-share P     share of NPCs in the hotspot (default 0.8)\n"
+              << "  --hotspot-size L      hotspot side length (default 50)\n"
+              << "  --range R             default battle range (default 10)\n"
+              << "  --file PATH           file used by save/load (default workload_dungeon.txt)\n"
+              << "  --ranges R1,R2,...    ranges evaluated by analyze (default 1,2,5,10,20)\n"
+              << "  --battle-threads T    threads for battle, 0 = hardware threads (default 1)\n"
+              << "  --feed NAME           publish battle events to a shared memory feed\n"
+              << "  --shards K            shard count for shard-save (default: hardware threads)\n"
+              << "  --script OPS          comma separated add,load,save,shard-load,shard-save,\n"
+              << "                        clear,battle[:range],analyze,render,verify[:range]\n"
+              << "                        verify runs every battle engine on the generated\n"
+              << "                        dungeon and checks it against the reference;\n"
+              << "                        the lossy compact engine only within its tolerance\n"
+              << "                        (default add,save,clear,load,battle)\n"
+              << "  --keep-file           do not delete the save file on exit\n"
+              << "  --compact             store NPCs in the compact fixed point representation\n";
+}
+
+bool parseMix(const std::string& value, WorkloadGenerator::Config& config){
+    std::stringstream ss(value);
+    std::string part;
+    std::vector<double> weights;
+    while (std::getline(ss, part, ':')){
+        try {
+            weights.push_back(std::stod(part));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (weights.size() != 3) return false;
+    config.squirrelWeight = weights[0];
+    config.werewolfWeight = weights[1];
+    config.druidWeight = weights[2];
+    return true;
+}
+
+bool parseRanges(const std::string& value, std::vector<double>& ranges){
+    std::stringstream ss(value);
+    std::string part;
+    ranges.clear();
+    while (std::getline(ss, part, ',')){
+        try {
+            ranges.push_back(std::stod(part));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !ranges.empty();
+}
+
+bool parseScript(const std::string& script, double defaultRange, std::vector<Step>& steps){
+    std::stringstream ss(script);
+    std::string token;
+    while (std::getline(ss, token, ',')){
+        if (token.empty()) continue;
+        Step step{token, defaultRange};
+        size_t colon = token.find(':');
+        if (colon != std::string::npos) {
+            step.op = token.substr(0, colon);
+            try {
+                step.range = std::stod(token.substr(colon + 1));
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        if (step.op != "add" && step.op != "load" && step.op != "save" &&
+            step.op != "shard-load" && step.op != "shard-save" &&
+            step.op != "clear" && step.op != "battle" && step.op != "analyze" &&
+            step.op != "render" && step.op != "verify") {
+            return false;
+        }
+        steps.push_back(step);
+    }
+    return !steps.empty();
+}
+
+bool parseArgs(int argc, char** argv, Options& options){
+    for (int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            std::exit(0);
+        }
+        if (arg == "--keep-file") {
+            options.keepFile = true;
+            continue;
+        }
+        if (arg == "--compact") {
+            options.compact = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--npcs") options.workload.npcCount = std::stoull(value);
+            else if (arg == "--seed") options.workload.seed = std::stoull(value);
+            else if (arg == "--battle-threads") options.battleThreads = std::stoull(value);
+            else if (arg == "--feed") options.feed = value;
+            else if (arg == "--shards") options.shards = std::stoull(value);
+            else if (arg == "--clusters") options.workload.clusterCount = std::stoull(value);
+            else if (arg == "--spread") options.workload.clusterSpread = std::stod(value);
+            else if (arg == "--hotspot-share") options.workload.hotspotShare = std::stod(value);
+            else if (arg == "--hotspot-size") options.workload.hotspotSize = std::stod(value);
+            else if (arg == "--range") options.range = std::stod(value);
+            else if (arg == "--file") options.file = value;
+            else if (arg == "--script") options.script = value;
+            else if (arg == "--mix") {
+                if (!parseMix(value, options.workload)) {
+                    std::cerr << "Error: --mix expects S:W:D weights" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--ranges") {
+                if (!parseRanges(value, options.analyzeRanges)) {
+                    std::cerr << "Error: --ranges expects comma separated numbers" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--distribution") {
+                bool ok = false;
+                options.workload.distribution = WorkloadGenerator::stringToDistribution(value, &ok);
+                if (!ok) {
+                    std::cerr << "Error: Unknown distribution '" << value << "'" << std::endl;
+                    return false;
+                }
+            } else {
+                std::cerr << "Error: Unknown option " << arg << std::endl;
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value '" << value << "' for " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+double elapsedSeconds(Clock::time_point start){
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string manifestFilename(const Options& options){
+    return options.file + ".manifest";
+}
+
+void removeShardedFiles(const Options& options){
+    std::ifstream manifest(manifestFilename(options));
+    std::string line;
+    std::getline(manifest, line);
+    std::filesystem::path directory = std::filesystem::path(manifestFilename(options)).parent_path();
+    while (std::getline(manifest, line)){
+        if (!line.empty()) std::filesystem::remove(directory / line);
+    }
+    manifest.close();
+    std::filesystem::remove(manifestFilename(options));
+}
+
+PhaseReport runStep(DungeonEditor& editor, const Step& step, const std::vector<NPCSpec>& specs, const Options& options){
+    PhaseReport report;
+    report.name = step.op;
+    if (step.op == "battle" || step.op == "verify") {
+        std::ostringstream label;
+        label << step.op << ":" << step.range;
+        report.name = label.str();
+    }
+    auto start = Clock::now();
+    if (step.op == "add") {
+        report.latencies.reserve(specs.size());
+        for (const auto& spec : specs){
+            auto opStart = Clock::now();
+            if (editor.addNPC(NPCFactory::typeToString(spec.type), spec.name, spec.x, spec.y)) {
+                report.items++;
+            }
+            report.latencies.push_back(elapsedSeconds(opStart));
+        }
+    } else if (step.op == "save") {
+        report.items = editor.getNPCCount();
+        editor.saveToFile(options.file);
+    } else if (step.op == "load") {
+        editor.loadFromFile(options.file);
+        report.items = editor.getNPCCount();
+    } else if (step.op == "shard-save") {
+        report.items = editor.getNPCCount();
+        editor.saveToFileSharded(manifestFilename(options), options.shards);
+    } else if (step.op == "shard-load") {
+        editor.loadFromFileSharded(manifestFilename(options));
+        report.items = editor.getNPCCount();
+    } else if (step.op == "clear") {
+        report.items = editor.getNPCCount();
+        editor.clearAll();
+    } else if (step.op == "battle") {
+        report.items = editor.getNPCCount();
+        editor.startBattle(step.range);
+    } else if (step.op == "verify") {
+        auto specs = BattleHarness::generate(options.workload);
+        report.items = specs.size();
+        BattleRun reference = BattleHarness::runReference(specs, step.range);
+        std::ostringstream referenceNote;
+        referenceNote << std::left << std::setw(12) << "reference" << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(12) << reference.seconds * 1e3 << " ms  "
+                      << reference.survivors.size() << " survivors, " << reference.events.size() << " events";
+        report.notes.push_back(referenceNote.str());
+        auto engines = BattleHarness::defaultEngines(options.battleThreads == 1 ? 0 : options.battleThreads);
+        for (const auto& comparison : BattleHarness::compare(reference, specs, step.range, engines)){
+            std::ostringstream note;
+            note << std::left << std::setw(12) << comparison.name << std::right << std::fixed
+                 << std::setprecision(3) << std::setw(12) << comparison.seconds * 1e3 << " ms  "
+                 << std::setprecision(2) << comparison.speedup << "x  "
+                 << (comparison.matches() ? "match" : "MISMATCH " + comparison.mismatch);
+            if (comparison.matches() && comparison.tolerance > 0.0) {
+                note << " within +-" << std::setprecision(4) << comparison.tolerance
+                     << " (" << comparison.survivorsDiffering << " survivors differ)";
+            }
+            report.notes.push_back(note.str());
+            report.failed = report.failed || !comparison.matches();
+        }
+    } else if (step.op == "render") {
+        report.items = editor.getNPCCount();
+        std::string table = editor.renderNPCTable();
+        std::ostringstream note;
+        note << table.size() << " bytes rendered";
+        report.notes.push_back(note.str());
+    } else if (step.op == "analyze") {
+        report.items = options.analyzeRanges.size();
+        for (const auto& outcome : editor.analyzeBattle(options.analyzeRanges)){
+            std::ostringstream note;
+            note << "range " << outcome.range << ": " << outcome.pairCount << " pairs, "
+                 << outcome.killed.size() << " killed, survivors S/W/D "
+                 << outcome.squirrels << "/" << outcome.werewolves << "/" << outcome.druids;
+            report.notes.push_back(note.str());
+        }
+    }
+    report.seconds = elapsedSeconds(start);
+    return report;
+}
+
+void printReport(const PhaseReport& report, size_t npcsAfter){
+    double throughput = report.seconds > 0.0 ? report.items / report.seconds : 0.0;
+    std::cout << std::left << std::setw(16) << report.name << std::right
+              << std::setw(10) << report.items
+              << std::setw(14) << std::fixed << std::setprecision(3) << report.seconds * 1e3
+              << std::setw(16) << std::setprecision(0) << throughput
+              << std::setw(10) << npcsAfter;
+    if (!report.latencies.empty()) {
+        auto latencies = report.latencies;
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double p){
+            return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))] * 1e6;
+        };
+        std::cout << "   p50=" << std::setprecision(2) << percentile(0.50) << "us"
+                  << " p99=" << percentile(0.99) << "us"
+                  << " max=" << latencies.back() * 1e6 << "us";
+    } else {
+        std::cout << "   latency=" << std::setprecision(3) << report.seconds * 1e3 << "ms";
+    }
+    std::cout << "\n";
+    for (const auto& note : report.notes){
+        std::cout << "    " << note << "\n";
+    }
+}
+
+}
+
+int main(int argc, char** argv){
+    Options options;
+    std::vector<Step> steps;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!parseScript(options.script, options.range, steps)) {
+        std::cerr << "Error: Invalid script '" << options.script << "'" << std::endl;
+        return 1;
+    }
+
+    auto generateStart = Clock::now();
+    auto specs = WorkloadGenerator(options.workload).generate();
+    double generateSeconds = elapsedSeconds(generateStart);
+
+    std::cout << "Workload: " << specs.size() << " NPCs, seed " << options.workload.seed
+              << ", distribution " << WorkloadGenerator::distributionToString(options.workload.distribution)
+              << ", mix " << options.workload.squirrelWeight << ":" << options.workload.werewolfWeight
+              << ":" << options.workload.druidWeight << "\n"
+              << "Generated in " << std::fixed << std::setprecision(3) << generateSeconds * 1e3 << " ms\n\n";
+    std::cout << std::left << std::setw(16) << "Phase" << std::right
+              << std::setw(10) << "Items"
+              << std::setw(14) << "Time(ms)"
+              << std::setw(16) << "Items/s"
+              << std::setw(10) << "NPCs"
+              << "   Latency\n"
+              << std::string(90, '-') << "\n";
+
+    auto editor = std::make_unique<DungeonEditor>();
+    editor->setQuiet(true);
+    editor->setCompactMode(options.compact);
+    editor->setBattleThreads(options.battleThreads);
+    if (!options.feed.empty() && !editor->attachSharedMemoryLogger(options.feed)) {
+        return 1;
+    }
+    double totalSeconds = 0.0;
+    bool failed = false;
+    for (const auto& step : steps){
+        PhaseReport report = runStep(*editor, step, specs, options);
+        totalSeconds += report.seconds;
+        failed = failed || report.failed;
+        printReport(report, editor->getNPCCount());
+    }
+    std::cout << std::string(90, '-') << "\n"
+              << "Total: " << std::setprecision(3) << totalSeconds * 1e3 << " ms" << std::endl;
+
+    auto memory = editor->getMemoryUsage();
+    std::cout << "Memory (" << (options.compact ? "compact" : "objects") << "): "
+              << "npcs " << memory.npcObjects << " B, names " << memory.names
+              << " B, indexes " << memory.indexes << " B, loggers " << memory.loggers
+              << " B, total " << memory.total() << " B";
+    if (editor->getNPCCount() > 0) {
+        std::cout << " (" << std::setprecision(1)
+                  << static_cast<double>(memory.total()) / editor->getNPCCount() << " B/NPC)";
+    }
+    std::cout << std::endl;
+
+    if (!options.keepFile) {
+        std::remove(options.file.c_str());
+        removeShardedFiles(options);
+    }
+    return failed ? 1 : 0;
+}
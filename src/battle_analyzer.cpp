@@ -0,0 +1,96 @@
+#include "../include/battle_analyzer.h"
+#include "../include/compact_store.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+BattleAnalyzer::BattleAnalyzer(const std::vector<std::shared_ptr<NPC>>& npcs, double maxRange){
+    const double never = std::numeric_limits<double>::infinity();
+    std::vector<NPC*> alive;
+    for (const auto& npc : npcs){
+        if (!npc->isAlive()) continue;
+        alive.push_back(npc.get());
+        std::string type = npc->getType();
+        Kind kind = type == "Werewolf" ? Kind::WEREWOLF : type == "Druid" ? Kind::DRUID : Kind::SQUIRREL;
+        entries.push_back({npc->getName(), kind, never});
+    }
+    for (size_t i = 0; i < alive.size(); i++){
+        for (size_t j = i + 1; j < alive.size(); j++){
+            double distance = alive[i]->calculateDistance(alive[j]);
+            if (distance > maxRange) continue;
+            pairDistances.push_back(distance);
+            if (alive[i]->canAttack(alive[j])) {
+                entries[j].deathRange = std::min(entries[j].deathRange, distance);
+            }
+            if (alive[j]->canAttack(alive[i])) {
+                entries[i].deathRange = std::min(entries[i].deathRange, distance);
+            }
+        }
+    }
+    std::sort(pairDistances.begin(), pairDistances.end());
+}
+
+BattleAnalyzer::BattleAnalyzer(const CompactNPCStore& store, double maxRange){
+    const double never = std::numeric_limits<double>::infinity();
+    entries.reserve(store.size());
+    for (size_t i = 0; i < store.size(); i++){
+        NPCFactory::NPCType type = store.getType(i);
+        Kind kind = type == NPCFactory::NPCType::WEREWOLF ? Kind::WEREWOLF
+                  : type == NPCFactory::NPCType::DRUID ? Kind::DRUID : Kind::SQUIRREL;
+        entries.push_back({std::string(store.getName(i)), kind, never});
+    }
+    for (size_t i = 0; i < store.size(); i++){
+        for (size_t j = i + 1; j < store.size(); j++){
+            double dx = store.getX(i) - store.getX(j);
+            double dy = store.getY(i) - store.getY(j);
+            double distance = std::sqrt(dx * dx + dy * dy);
+            if (distance > maxRange) continue;
+            pairDistances.push_back(distance);
+            if (CompactNPCStore::canAttack(store.getType(i), store.getType(j))) {
+                entries[j].deathRange = std::min(entries[j].deathRange, distance);
+            }
+            if (CompactNPCStore::canAttack(store.getType(j), store.getType(i))) {
+                entries[i].deathRange = std::min(entries[i].deathRange, distance);
+            }
+        }
+    }
+    std::sort(pairDistances.begin(), pairDistances.end());
+}
+
+BattleOutcome BattleAnalyzer::evaluate(double range) const{
+    BattleOutcome outcome;
+    outcome.range = range;
+    outcome.pairCount = static_cast<size_t>(std::upper_bound(pairDistances.begin(), pairDistances.end(), range) - pairDistances.begin());
+    for (const auto& entry : entries){
+        if (entry.deathRange <= range) {
+            outcome.killed.push_back(entry.name);
+            continue;
+        }
+        switch (entry.kind){
+            case Kind::SQUIRREL: outcome.squirrels++; break;
+            case Kind::WEREWOLF: outcome.werewolves++; break;
+            case Kind::DRUID: outcome.druids++; break;
+        }
+    }
+    return outcome;
+}
+
+std::vector<BattleOutcome> BattleAnalyzer::evaluate(const std::vector<double>& ranges) const{
+    std::vector<BattleOutcome> outcomes;
+    outcomes.reserve(ranges.size());
+    for (double range : ranges){
+        outcomes.push_back(evaluate(range));
+    }
+    return outcomes;
+}
+
+std::vector<BattleOutcome> BattleAnalyzer::analyze(const std::vector<std::shared_ptr<NPC>>& npcs, const std::vector<double>& ranges){
+    if (ranges.empty()) return {};
+    double maxRange = *std::max_element(ranges.begin(), ranges.end());
+    return BattleAnalyzer(npcs, maxRange).evaluate(ranges);
+}
+std::vector<BattleOutcome> BattleAnalyzer::analyze(const CompactNPCStore& store, const std::vector<double>& ranges){
+    if (ranges.empty()) return {};
+    double maxRange = *std::max_element(ranges.begin(), ranges.end());
+    return BattleAnalyzer(store, maxRange).evaluate(ranges);
+}
@@ -0,0 +1,253 @@
+#include "../include/battle_harness.h"
+#include "../include/battle_analyzer.h"
+#include "../include/compact_store.h"
+#include "../include/npc_factory.h"
+#include "../include/observer.h"
+#include "../include/tiled_world.h"
+#include "../include/visitor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class RecordingObserver : public BattleObserver {
+public:
+    std::vector<std::string> events;
+    void update(const std::string& event) override { events.push_back(event); }
+};
+
+std::vector<std::string> namesOf(const std::vector<std::shared_ptr<NPC>>& npcs){
+    std::vector<std::string> names;
+    names.reserve(npcs.size());
+    for (const auto& npc : npcs){
+        names.push_back(npc->getName());
+    }
+    return names;
+}
+
+double secondsSince(Clock::time_point start){
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+BattleRun runParallel(const std::vector<NPCSpec>& specs, double range, size_t threads){
+    BattleRun run;
+    auto npcs = BattleHarness::buildNPCs(specs);
+    BattleLogger logger;
+    RecordingObserver recorder;
+    logger.attach(&recorder);
+    auto start = Clock::now();
+    BattleVisitor(npcs, range, &logger).executeBattleParallel(threads);
+    run.seconds = secondsSince(start);
+    run.survivors = namesOf(npcs);
+    run.events = std::move(recorder.events);
+    return run;
+}
+
+BattleRun runCompact(const std::vector<NPCSpec>& specs, double range){
+    BattleRun run;
+    CompactNPCStore store;
+    store.reserve(specs.size());
+    for (const auto& spec : specs){
+        store.add(spec.type, spec.name, spec.x, spec.y);
+    }
+    BattleLogger logger;
+    RecordingObserver recorder;
+    logger.attach(&recorder);
+    auto start = Clock::now();
+    store.executeBattle(range, &logger);
+    run.seconds = secondsSince(start);
+    for (size_t i = 0; i < store.size(); i++){
+        run.survivors.emplace_back(store.getName(i));
+    }
+    run.events = std::move(recorder.events);
+    return run;
+}
+
+BattleRun runAnalyzer(const std::vector<NPCSpec>& specs, double range){
+    BattleRun run;
+    auto npcs = BattleHarness::buildNPCs(specs);
+    auto start = Clock::now();
+    BattleOutcome outcome = BattleAnalyzer(npcs, range).evaluate(range);
+    run.seconds = secondsSince(start);
+    size_t next = 0;
+    for (const auto& npc : npcs){
+        if (next < outcome.killed.size() && outcome.killed[next] == npc->getName()) {
+            next++;
+            continue;
+        }
+        run.survivors.push_back(npc->getName());
+    }
+    return run;
+}
+
+// Shifted by a quarter world so the dungeon straddles all four tile borders.
+BattleRun runTiled(const std::vector<NPCSpec>& specs, double range){
+    static std::atomic<unsigned> runCounter{0};
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+        ("battle_harness_" + std::to_string(getpid()) + "_" + std::to_string(runCounter++));
+    BattleRun run;
+    {
+        TiledWorld world(directory.string(), 2, 2, 4);
+        for (const auto& spec : specs){
+            world.addNPC(NPCFactory::typeToString(spec.type), spec.name, spec.x + 250.0, spec.y + 250.0);
+        }
+        RecordingObserver recorder;
+        world.getBattleLogger().attach(&recorder);
+        auto start = Clock::now();
+        world.startBattle(range);
+        run.seconds = secondsSince(start);
+        for (size_t ty = 0; ty < 2; ty++){
+            for (size_t tx = 0; tx < 2; tx++){
+                auto names = world.tile(tx, ty).getNPCNames();
+                run.survivors.insert(run.survivors.end(), names.begin(), names.end());
+            }
+        }
+        world.getBattleLogger().detach(&recorder);
+        run.events = std::move(recorder.events);
+    }
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return run;
+}
+
+size_t survivorsDiffering(std::vector<std::string> expected, std::vector<std::string> actual){
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    std::vector<std::string> difference;
+    std::set_symmetric_difference(expected.begin(), expected.end(), actual.begin(), actual.end(),
+                                  std::back_inserter(difference));
+    return difference.size();
+}
+
+// Kills and events only grow with the range, so an engine whose distances are
+// off by at most the tolerance lands between the two bracketing references.
+void compareWithin(const std::vector<NPCSpec>& specs, double range, const BattleEngine& engine,
+                   BattleRun run, EngineComparison& comparison){
+    BattleRun narrow = BattleHarness::runReference(specs, range - engine.tolerance);
+    BattleRun wide = BattleHarness::runReference(specs, range + engine.tolerance);
+    for (auto* names : {&narrow.survivors, &narrow.events, &wide.survivors, &wide.events, &run.survivors, &run.events}){
+        std::sort(names->begin(), names->end());
+    }
+    comparison.survivorsMatch = std::includes(run.survivors.begin(), run.survivors.end(), wide.survivors.begin(), wide.survivors.end()) &&
+                                std::includes(narrow.survivors.begin(), narrow.survivors.end(), run.survivors.begin(), run.survivors.end());
+    comparison.eventsMatch = !engine.reportsEvents ||
+                             (std::includes(run.events.begin(), run.events.end(), narrow.events.begin(), narrow.events.end()) &&
+                              std::includes(wide.events.begin(), wide.events.end(), run.events.begin(), run.events.end()));
+    if (!comparison.survivorsMatch) {
+        comparison.mismatch = "survivors outside the tolerance of " + std::to_string(engine.tolerance);
+    } else if (!comparison.eventsMatch) {
+        comparison.mismatch = "events outside the tolerance of " + std::to_string(engine.tolerance);
+    }
+}
+
+std::string firstDifference(const std::vector<std::string>& expected, const std::vector<std::string>& actual){
+    size_t i = 0;
+    while (i < expected.size() && i < actual.size() && expected[i] == actual[i]) i++;
+    std::string result = "at " + std::to_string(i) + ": expected '";
+    result += i < expected.size() ? expected[i] : "<end>";
+    result += "', got '";
+    result += i < actual.size() ? actual[i] : "<end>";
+    return result + "'";
+}
+
+}
+
+std::vector<NPCSpec> BattleHarness::generate(const WorkloadGenerator::Config& config){
+    return WorkloadGenerator(config).generate();
+}
+
+std::vector<NPCSpec> BattleHarness::snapToCompactGrid(std::vector<NPCSpec> specs){
+    for (auto& spec : specs){
+        spec.x = CompactNPCStore::decodeCoordinate(CompactNPCStore::encodeCoordinate(spec.x));
+        spec.y = CompactNPCStore::decodeCoordinate(CompactNPCStore::encodeCoordinate(spec.y));
+    }
+    return specs;
+}
+
+double BattleHarness::compactTolerance(){
+    return 3.0 * CompactNPCStore::kStep;
+}
+
+std::vector<std::shared_ptr<NPC>> BattleHarness::buildNPCs(const std::vector<NPCSpec>& specs){
+    std::vector<std::shared_ptr<NPC>> npcs;
+    npcs.reserve(specs.size());
+    for (const auto& spec : specs){
+        auto npc = NPCFactory::createNPC(spec.type, spec.name, spec.x, spec.y);
+        if (npc) npcs.push_back(npc);
+    }
+    return npcs;
+}
+
+BattleRun BattleHarness::runReference(const std::vector<NPCSpec>& specs, double range){
+    BattleRun run;
+    auto npcs = buildNPCs(specs);
+    BattleLogger logger;
+    RecordingObserver recorder;
+    logger.attach(&recorder);
+    auto start = Clock::now();
+    BattleVisitor(npcs, range, &logger).executeBattle();
+    run.seconds = secondsSince(start);
+    run.survivors = namesOf(npcs);
+    run.events = std::move(recorder.events);
+    return run;
+}
+
+std::vector<BattleEngine> BattleHarness::defaultEngines(size_t threads){
+    if (threads == 0) {
+        threads = std::max(2u, std::thread::hardware_concurrency());
+    }
+    return {
+        {"parallel-" + std::to_string(threads), true, true,
+            [threads](const std::vector<NPCSpec>& specs, double range){ return runParallel(specs, range, threads); }},
+        {"compact", true, true, runCompact, compactTolerance()},
+        {"analyzer", true, false, runAnalyzer},
+        {"tiled-2x2", false, true, runTiled},
+    };
+}
+
+std::vector<EngineComparison> BattleHarness::compare(const std::vector<NPCSpec>& specs, double range,
+                                                     const std::vector<BattleEngine>& engines){
+    return compare(runReference(specs, range), specs, range, engines);
+}
+
+std::vector<EngineComparison> BattleHarness::compare(const BattleRun& reference, const std::vector<NPCSpec>& specs,
+                                                     double range, const std::vector<BattleEngine>& engines){
+    std::vector<EngineComparison> comparisons;
+    for (const auto& engine : engines){
+        BattleRun run = engine.run(specs, range);
+        EngineComparison comparison;
+        comparison.name = engine.name;
+        comparison.seconds = run.seconds;
+        comparison.speedup = run.seconds > 0.0 ? reference.seconds / run.seconds : 0.0;
+        comparison.tolerance = engine.tolerance;
+        comparison.survivorsDiffering = survivorsDiffering(reference.survivors, run.survivors);
+        if (engine.tolerance > 0.0) {
+            compareWithin(specs, range, engine, run, comparison);
+            comparisons.push_back(std::move(comparison));
+            continue;
+        }
+        BattleRun expected = reference;
+        if (!engine.ordered) {
+            std::sort(expected.survivors.begin(), expected.survivors.end());
+            std::sort(expected.events.begin(), expected.events.end());
+            std::sort(run.survivors.begin(), run.survivors.end());
+            std::sort(run.events.begin(), run.events.end());
+        }
+        comparison.survivorsMatch = run.survivors == expected.survivors;
+        comparison.eventsMatch = !engine.reportsEvents || run.events == expected.events;
+        if (!comparison.survivorsMatch) {
+            comparison.mismatch = "survivors differ " + firstDifference(expected.survivors, run.survivors);
+        } else if (!comparison.eventsMatch) {
+            comparison.mismatch = "events differ " + firstDifference(expected.events, run.events);
+        }
+        comparisons.push_back(std::move(comparison));
+    }
+    return comparisons;
+}
@@ -0,0 +1,225 @@
+#include "../include/compact_store.h"
+#include "../include/observer.h"
+#include "../include/visitor.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+uint16_t CompactNPCStore::encodeCoordinate(double value){
+    // Code c stands for (c + 1) * kStep, so code 0 is still inside (0, 500].
+    double code = std::round(value / kStep) - 1.0;
+    return static_cast<uint16_t>(std::clamp(code, 0.0, 65535.0));
+}
+double CompactNPCStore::decodeCoordinate(uint16_t code){
+    return (static_cast<double>(code) + 1.0) * kStep;
+}
+bool CompactNPCStore::canAttack(NPCFactory::NPCType attacker, NPCFactory::NPCType target){
+    switch (attacker){
+        case NPCFactory::NPCType::SQUIRREL:
+            return target == NPCFactory::NPCType::WEREWOLF || target == NPCFactory::NPCType::DRUID;
+        case NPCFactory::NPCType::WEREWOLF:
+            return target == NPCFactory::NPCType::DRUID;
+        default:
+            return false;
+    }
+}
+std::string CompactNPCStore::typeName(NPCFactory::NPCType type){
+    switch (type){
+        case NPCFactory::NPCType::SQUIRREL: return "Squirrel";
+        case NPCFactory::NPCType::WEREWOLF: return "Werewolf";
+        case NPCFactory::NPCType::DRUID: return "Druid";
+        default: return "Unknown";
+    }
+}
+
+void CompactNPCStore::setTypeTag(size_t index, NPCFactory::NPCType type){
+    size_t byte = index / 4;
+    unsigned shift = static_cast<unsigned>(index % 4) * 2;
+    if (byte >= typeTags.size()) {
+        typeTags.resize(byte + 1, 0);
+    }
+    typeTags[byte] = static_cast<uint8_t>((typeTags[byte] & ~(3u << shift)) | (static_cast<unsigned>(type) << shift));
+}
+NPCFactory::NPCType CompactNPCStore::getType(size_t index) const{
+    unsigned shift = static_cast<unsigned>(index % 4) * 2;
+    return static_cast<NPCFactory::NPCType>((typeTags[index / 4] >> shift) & 3u);
+}
+std::string_view CompactNPCStore::getName(size_t index) const{
+    return std::string_view(nameArena.data() + nameOffsets[index], nameOffsets[index + 1] - nameOffsets[index]);
+}
+double CompactNPCStore::getX(size_t index) const{ return decodeCoordinate(xs[index]); }
+double CompactNPCStore::getY(size_t index) const{ return decodeCoordinate(ys[index]); }
+size_t CompactNPCStore::size() const{ return xs.size(); }
+bool CompactNPCStore::empty() const{ return xs.empty(); }
+
+bool CompactNPCStore::add(NPCFactory::NPCType type, const std::string& name, double x, double y){
+    if (!NPC::isValidCoordinates(x, y)) {
+        std::cerr << "Error: Coordinates must be in range (0 < x <= 500, 0 < y <= 500)" << std::endl;
+        return false;
+    }
+    size_t index = xs.size();
+    xs.push_back(encodeCoordinate(x));
+    ys.push_back(encodeCoordinate(y));
+    setTypeTag(index, type);
+    nameArena.insert(nameArena.end(), name.begin(), name.end());
+    nameOffsets.push_back(static_cast<uint32_t>(nameArena.size()));
+    return true;
+}
+bool CompactNPCStore::contains(std::string_view name) const{
+    for (size_t i = 0; i < size(); i++){
+        if (getName(i) == name) return true;
+    }
+    return false;
+}
+void CompactNPCStore::clear(){
+    xs.clear();
+    ys.clear();
+    typeTags.clear();
+    nameArena.clear();
+    nameOffsets.assign(1, 0);
+}
+void CompactNPCStore::reserve(size_t count, size_t nameBytes){
+    xs.reserve(count);
+    ys.reserve(count);
+    typeTags.reserve((count + 3) / 4);
+    nameOffsets.reserve(count + 1);
+    nameArena.reserve(nameBytes);
+}
+void CompactNPCStore::shrinkToFit(){
+    xs.shrink_to_fit();
+    ys.shrink_to_fit();
+    typeTags.shrink_to_fit();
+    nameArena.shrink_to_fit();
+    nameOffsets.shrink_to_fit();
+}
+
+void CompactNPCStore::assign(const std::vector<std::shared_ptr<NPC>>& npcs){
+    clear();
+    size_t nameBytes = 0;
+    for (const auto& npc : npcs){
+        nameBytes += npc->getName().size();
+    }
+    reserve(npcs.size(), nameBytes);
+    for (const auto& npc : npcs){
+        if (npc->isAlive()) {
+            add(NPCFactory::stringToType(npc->getType()), npc->getName(), npc->getX(), npc->getY());
+        }
+    }
+}
+std::vector<std::shared_ptr<NPC>> CompactNPCStore::materialize() const{
+    std::vector<std::shared_ptr<NPC>> npcs;
+    npcs.reserve(size());
+    for (size_t i = 0; i < size(); i++){
+        auto npc = NPCFactory::createNPC(getType(i), std::string(getName(i)), getX(i), getY(i));
+        if (npc) npcs.push_back(npc);
+    }
+    return npcs;
+}
+
+void CompactNPCStore::removeDead(const std::vector<uint8_t>& alive){
+    size_t write = 0;
+    uint32_t nameWrite = 0;
+    for (size_t read = 0; read < size(); read++){
+        if (!alive[read]) continue;
+        NPCFactory::NPCType type = getType(read);
+        uint32_t begin = nameOffsets[read];
+        uint32_t length = nameOffsets[read + 1] - begin;
+        std::copy(nameArena.begin() + begin, nameArena.begin() + begin + length, nameArena.begin() + nameWrite);
+        xs[write] = xs[read];
+        ys[write] = ys[read];
+        setTypeTag(write, type);
+        nameOffsets[write] = nameWrite;
+        nameWrite += length;
+        write++;
+    }
+    xs.resize(write);
+    ys.resize(write);
+    typeTags.resize((write + 3) / 4);
+    nameOffsets.resize(write + 1);
+    nameOffsets[write] = nameWrite;
+    nameArena.resize(nameWrite);
+}
+
+void CompactNPCStore::executeBattle(double range, BattleLogger* logger){
+    // Same pair order and rules as BattleVisitor::executeBattle, with the range
+    // test done on squared distances in fixed point units. Squaring would turn
+    // a negative range positive, but distance <= range never holds for one.
+    if (!(range >= 0)) return;
+    double codeRange = range / kStep;
+    double threshold = codeRange * codeRange;
+    std::vector<uint8_t> alive(size(), 1);
+    for (size_t i = 0; i < size(); i++){
+        NPCFactory::NPCType type1 = getType(i);
+        for (size_t j = i + 1; j < size(); j++){
+            int64_t dx = static_cast<int64_t>(xs[i]) - xs[j];
+            int64_t dy = static_cast<int64_t>(ys[i]) - ys[j];
+            if (static_cast<double>(dx * dx + dy * dy) > threshold) continue;
+            NPCFactory::NPCType type2 = getType(j);
+            bool npc1Can = canAttack(type1, type2);
+            bool npc2Can = canAttack(type2, type1);
+            if (!npc1Can && !npc2Can) continue;
+            if (npc2Can) alive[i] = 0;
+            if (npc1Can) alive[j] = 0;
+            if (logger) logger->logBattleEvent(battleEventText(getName(i), typeName(type1), getName(j), typeName(type2), npc1Can, npc2Can));
+        }
+    }
+    removeDead(alive);
+}
+
+bool CompactNPCStore::saveToFile(const std::string& filename, bool verbose) const{
+    std::ofstream file(filename);
+    if (!file.is_open()){
+        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < size(); i++){
+        file << NPCFactory::typeToString(getType(i)) << ","
+             << getName(i) << ","
+             << getX(i) << ","
+             << getY(i) << "\n";
+    }
+    file.close();
+    if (verbose) std::cout << "Saved " << size() << " NPCs to " << filename << std::endl;
+    return true;
+}
+bool CompactNPCStore::saveToFileSharded(const std::string& manifestFilename, size_t shardCount, bool verbose) const{
+    return NPCFactory::saveRowsSharded(size(), [this](std::ostream& out, size_t i){
+        out << NPCFactory::typeToString(getType(i)) << ","
+            << getName(i) << ","
+            << getX(i) << ","
+            << getY(i) << "\n";
+    }, manifestFilename, shardCount, verbose);
+}
+bool CompactNPCStore::loadFromFile(const std::string& filename, bool verbose){
+    std::ifstream file(filename);
+    if (!file.is_open()){
+        std::cerr << "Error: Cannot open file " << filename << " for reading" << std::endl;
+        return false;
+    }
+    CompactNPCStore loaded;
+    std::string line;
+    while (std::getline(file, line)){
+        std::stringstream ss(line);
+        std::string typeStr, name;
+        double x, y;
+        if (std::getline(ss, typeStr, ',') && std::getline(ss, name, ',') && (ss >> x) && ss.ignore() && (ss >> y)) {
+            loaded.add(NPCFactory::stringToType(typeStr), name, x, y);
+        }
+    }
+    file.close();
+    if (verbose) std::cout << "Loaded " << loaded.size() << " NPCs from " << filename << std::endl;
+    if (loaded.empty()) return false;
+    loaded.shrinkToFit();
+    *this = std::move(loaded);
+    return true;
+}
+
+CompactNPCStore::MemoryUsage CompactNPCStore::memoryUsage() const{
+    MemoryUsage usage;
+    usage.coordinates = (xs.capacity() + ys.capacity()) * sizeof(uint16_t);
+    usage.typeTags = typeTags.capacity() * sizeof(uint8_t);
+    usage.names = nameArena.capacity() * sizeof(char) + nameOffsets.capacity() * sizeof(uint32_t);
+    return usage;
+}
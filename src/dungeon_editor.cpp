@@ -1,20 +1,54 @@
 #include "../include/dungeon_editor.h"
 #include "../include/npc_factory.h"
 #include "../include/visitor.h"
+#include <algorithm>
+#include <charconv>
 #include <iostream>
-#include <iomanip>
+#include <string_view>
+
+namespace {
+
+void appendPadded(std::string& out, std::string_view text, size_t width){
+    out.append(text);
+    if (text.size() < width) out.append(width - text.size(), ' ');
+}
+
+// Same digits as operator<< with the default stream precision.
+void appendNumber(std::string& out, double value, size_t width){
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+    appendPadded(out, std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)), width);
+}
+
+void appendCount(std::string& out, size_t value){
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+ConsoleLogger& sharedConsoleLogger(){
+    static ConsoleLogger consoleLogger;
+    return consoleLogger;
+}
+
+}
 
 DungeonEditor::DungeonEditor(){
     attachConsoleLogger();
 }
 
 bool DungeonEditor::addNPC(const std::string& type, const std::string& name, double x, double y){
+    bool duplicate = compactMode ? compactStore.contains(name) : false;
     for (const auto& npc : npcs){
         if (npc->getName() == name){
-            std::cerr << "Error: NPC with name '" << name << "' already exists" << std::endl;
-            return false;
+            duplicate = true;
+            break;
         }
     }
+    if (duplicate){
+        std::cerr << "Error: NPC with name '" << name << "' already exists" << std::endl;
+        return false;
+    }
     NPCFactory::NPCType npcType;
     if (type == "squirrel" || type == "SQUIRREL"){
         npcType = NPCFactory::NPCType::SQUIRREL;
@@ -26,60 +60,202 @@ bool DungeonEditor::addNPC(const std::string& type, const std::string& name, dou
         std::cerr << "Error: Unknown NPC type '" << type << "'" << std::endl;
         return false;
     }
+    if (compactMode) {
+        if (!compactStore.add(npcType, name, x, y)) return false;
+        if (!quiet) std::cout << "Added " << type << " '" << name << "' at (" << x << ", " << y << ")" << std::endl;
+        return true;
+    }
     auto npc = NPCFactory::createNPC(npcType, name, x, y);
     if (npc) {
         npcs.push_back(npc);
-        std::cout << "Added " << type << " '" << name << "' at (" << x << ", " << y << ")" << std::endl;
+        if (!quiet) std::cout << "Added " << type << " '" << name << "' at (" << x << ", " << y << ")" << std::endl;
         return true;
     }
     return false;
 }
 void DungeonEditor::printAllNPCs() const{
-    std::cout << "\n=== NPC List ===" << std::endl;
-    std::cout << std::left << std::setw(15) << "Type" 
-              << std::setw(20) << "Name" 
-              << std::setw(10) << "X" 
-              << std::setw(10) << "Y" 
-              << "Status" << std::endl;
-    std::cout << std::string(60, '-') << std::endl;
+    printNPCs(NPCListOptions());
+}
+void DungeonEditor::printNPCs(const NPCListOptions& options) const{
+    std::string table = renderNPCTable(options);
+    std::cout.write(table.data(), static_cast<std::streamsize>(table.size()));
+    std::cout.flush();
+}
+std::string DungeonEditor::renderNPCTable(const NPCListOptions& options) const{
+    size_t total = getNPCCount();
+    size_t rows = std::min(options.limit, total);
+    std::string out;
+    out.reserve(160 + rows * 72);
+    out += "\n=== NPC List ===\n";
+    appendPadded(out, "Type", 15);
+    appendPadded(out, "Name", 20);
+    appendPadded(out, "X", 10);
+    appendPadded(out, "Y", 10);
+    out += "Status\n";
+    out.append(60, '-');
+    out += '\n';
+
+    size_t matched = 0;
+    size_t shown = 0;
+    auto appendRow = [&](NPCFactory::NPCType type, std::string_view name, double x, double y, bool alive){
+        if (options.type && *options.type != type) return;
+        if (options.alive && *options.alive != alive) return;
+        if (x < options.minX || x > options.maxX || y < options.minY || y > options.maxY) return;
+        if (matched++ < options.offset || shown >= options.limit) return;
+        appendPadded(out, CompactNPCStore::typeName(type), 15);
+        appendPadded(out, name, 20);
+        appendNumber(out, x, 10);
+        appendNumber(out, y, 10);
+        out += alive ? "Alive\n" : "Dead\n";
+        shown++;
+    };
     for (const auto& npc : npcs){
-        std::cout << std::left << std::setw(15) << npc->getType()
-                  << std::setw(20) << npc->getName()
-                  << std::setw(10) << npc->getX()
-                  << std::setw(10) << npc->getY()
-                  << (npc->isAlive() ? "Alive" : "Dead") << std::endl;
+        appendRow(NPCFactory::stringToType(npc->getType()), npc->getName(), npc->getX(), npc->getY(), npc->isAlive());
     }
-    std::cout << "Total: " << npcs.size() << " NPCs" << std::endl;
+    for (size_t i = 0; i < compactStore.size(); i++){
+        appendRow(compactStore.getType(i), compactStore.getName(i), compactStore.getX(i), compactStore.getY(i), true);
+    }
+
+    if (shown != total) {
+        out += "Shown: ";
+        appendCount(out, shown);
+        out += " of ";
+        appendCount(out, matched);
+        out += " matching\n";
+    }
+    out += "Total: ";
+    appendCount(out, total);
+    out += " NPCs\n";
+    return out;
 }
 void DungeonEditor::startBattle(double range){
-    std::cout << "\n=== Starting Battle (Range: " << range << "m) ===" << std::endl;
-    BattleVisitor visitor(npcs, range, &battleLogger);
-    visitor.executeBattle();
-    std::cout << "Battle finished. Remaining NPCs: " << npcs.size() << std::endl;
+    if (!quiet) std::cout << "\n=== Starting Battle (Range: " << range << "m) ===" << std::endl;
+    if (compactMode) {
+        compactStore.executeBattle(range, &battleLogger);
+    } else {
+        BattleVisitor visitor(npcs, range, &battleLogger);
+        if (battleThreads == 1) {
+            visitor.executeBattle();
+        } else {
+            visitor.executeBattleParallel(battleThreads);
+        }
+    }
+    if (!quiet) std::cout << "Battle finished. Remaining NPCs: " << getNPCCount() << std::endl;
+}
+std::vector<BattleOutcome> DungeonEditor::analyzeBattle(const std::vector<double>& ranges) const{
+    if (compactMode) return BattleAnalyzer::analyze(compactStore, ranges);
+    return BattleAnalyzer::analyze(npcs, ranges);
 }
 bool DungeonEditor::saveToFile(const std::string& filename) const {
-    return NPCFactory::saveToFile(npcs, filename);
+    if (compactMode) return compactStore.saveToFile(filename, !quiet);
+    return NPCFactory::saveToFile(npcs, filename, !quiet);
 }
 bool DungeonEditor::loadFromFile(const std::string& filename){
-    auto loadedNPCs = NPCFactory::loadFromFile(filename);
+    if (compactMode) return compactStore.loadFromFile(filename, !quiet);
+    auto loadedNPCs = NPCFactory::loadFromFile(filename, !quiet);
     if (!loadedNPCs.empty()) {
         npcs = loadedNPCs;
         return true;
     }
     return false;
 }
+bool DungeonEditor::saveToFileSharded(const std::string& manifestFilename, size_t shardCount) const {
+    if (compactMode) return compactStore.saveToFileSharded(manifestFilename, shardCount, !quiet);
+    return NPCFactory::saveToFileSharded(npcs, manifestFilename, shardCount, !quiet);
+}
+bool DungeonEditor::loadFromFileSharded(const std::string& manifestFilename){
+    auto loadedNPCs = NPCFactory::loadFromFileSharded(manifestFilename, !quiet);
+    if (loadedNPCs.empty()) return false;
+    if (compactMode) {
+        compactStore.assign(loadedNPCs);
+    } else {
+        npcs = std::move(loadedNPCs);
+    }
+    return true;
+}
 void DungeonEditor::attachConsoleLogger(){
-    static ConsoleLogger consoleLogger;
-    battleLogger.attach(&consoleLogger);
+    battleLogger.attach(&sharedConsoleLogger());
 }
 void DungeonEditor::attachFileLogger(const std::string& filename){
     static FileLogger fileLogger(filename);
     battleLogger.attach(&fileLogger);
 }
+bool DungeonEditor::attachSharedMemoryLogger(const std::string& name){
+    // The old feed goes first: its destructor unlinks the name, which would
+    // remove a new feed created under the same name.
+    if (sharedMemoryLogger) {
+        battleLogger.detach(sharedMemoryLogger.get());
+        sharedMemoryLogger.reset();
+    }
+    sharedMemoryLogger = std::make_unique<SharedMemoryLogger>(name);
+    if (!sharedMemoryLogger->isOpen()) {
+        sharedMemoryLogger.reset();
+        return false;
+    }
+    battleLogger.attach(sharedMemoryLogger.get());
+    return true;
+}
 size_t DungeonEditor::getNPCCount() const{
-    return npcs.size();
+    return compactMode ? compactStore.size() : npcs.size();
+}
+std::vector<std::string> DungeonEditor::getNPCNames() const{
+    std::vector<std::string> names;
+    names.reserve(getNPCCount());
+    for (const auto& npc : npcs){
+        names.push_back(npc->getName());
+    }
+    for (size_t i = 0; i < compactStore.size(); i++){
+        names.emplace_back(compactStore.getName(i));
+    }
+    return names;
 }
 void DungeonEditor::clearAll() {
     npcs.clear();
-    std::cout << "All NPCs cleared" << std::endl;
+    compactStore.clear();
+    if (!quiet) std::cout << "All NPCs cleared" << std::endl;
+}
+DungeonEditor::MemoryUsage DungeonEditor::getMemoryUsage() const{
+    MemoryUsage usage;
+    // make_shared puts the object and its control block (vptr + two counters)
+    // in a single allocation.
+    const size_t controlBlock = sizeof(void*) + 2 * sizeof(int);
+    const size_t inlineNameCapacity = std::string().capacity();
+    for (const auto& npc : npcs){
+        usage.npcObjects += controlBlock + sizeof(*npc);
+        size_t length = npc->getName().size();
+        if (length > inlineNameCapacity) usage.names += length + 1;
+    }
+    usage.indexes = npcs.capacity() * sizeof(std::shared_ptr<NPC>);
+    auto compact = compactStore.memoryUsage();
+    usage.npcObjects += compact.coordinates + compact.typeTags;
+    usage.names += compact.names;
+    usage.loggers = battleLogger.memoryUsage();
+    return usage;
+}
+void DungeonEditor::setCompactMode(bool enabled){
+    if (enabled == compactMode) return;
+    if (enabled) {
+        compactStore.assign(npcs);
+        npcs.clear();
+        npcs.shrink_to_fit();
+    } else {
+        npcs = compactStore.materialize();
+        compactStore.clear();
+        compactStore.shrinkToFit();
+    }
+    compactMode = enabled;
+}
+bool DungeonEditor::isCompactMode() const{
+    return compactMode;
+}
+void DungeonEditor::setBattleThreads(size_t threads){
+    battleThreads = threads;
+}
+void DungeonEditor::setQuiet(bool enabled){
+    quiet = enabled;
+    battleLogger.detach(&sharedConsoleLogger());
+    if (!quiet) battleLogger.attach(&sharedConsoleLogger());
+}
+bool DungeonEditor::isQuiet() const{
+    return quiet;
 }
\ No newline at end of file
@@ -1,7 +1,44 @@
 #include "../include/npc_factory.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <filesystem>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+
+void writeRecord(std::ostream& out, const NPC& npc){
+    out << NPCFactory::typeToString(NPCFactory::stringToType(npc.getType())) << ","
+        << npc.getName() << ","
+        << npc.getX() << ","
+        << npc.getY() << "\n";
+}
+
+bool parseRecord(const std::string& line, std::string& typeStr, std::string& name, double& x, double& y){
+    std::stringstream ss(line);
+    return std::getline(ss, typeStr, ',') && std::getline(ss, name, ',') && (ss >> x) && ss.ignore() && (ss >> y);
+}
+
+std::vector<std::shared_ptr<NPC>> parseStream(std::istream& in){
+    std::vector<std::shared_ptr<NPC>> parsed;
+    std::string line, typeStr, name;
+    double x, y;
+    while (std::getline(in, line)){
+        if (parseRecord(line, typeStr, name, x, y)) {
+            auto npc = NPCFactory::createNPC(NPCFactory::stringToType(typeStr), name, x, y);
+            if (npc){
+                parsed.push_back(npc);
+            }
+        }
+    }
+    return parsed;
+}
+
+const char* kManifestTag = "NPC_SHARDS";
+
+}
 
 std::shared_ptr<NPC> NPCFactory::createNPC(NPCType type, const std::string& name, double x, double y){
     if (!NPC::isValidCoordinates(x, y)) {
@@ -19,7 +56,7 @@ std::shared_ptr<NPC> NPCFactory::createNPC(NPCType type, const std::string& name
             return nullptr;
     }
 }
-bool NPCFactory::saveToFile(const std::vector<std::shared_ptr<NPC>>& npcs, const std::string& filename){
+bool NPCFactory::saveToFile(const std::vector<std::shared_ptr<NPC>>& npcs, const std::string& filename, bool verbose){
     std::ofstream file(filename);
     if (!file.is_open()){
         std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
@@ -27,44 +64,154 @@ bool NPCFactory::saveToFile(const std::vector<std::shared_ptr<NPC>>& npcs, const
     }
     for (const auto& npc : npcs){
         if (npc->isAlive()) {
-            file << typeToString(stringToType(npc->getType())) << ","
-                 << npc->getName() << ","
-                 << npc->getX() << ","
-                 << npc->getY() << "\n";
+            writeRecord(file, *npc);
         }
     }
     file.close();
-    std::cout << "Saved " << npcs.size() << " NPCs to " << filename << std::endl;
+    if (verbose) std::cout << "Saved " << npcs.size() << " NPCs to " << filename << std::endl;
     return true;
 }
-std::vector<std::shared_ptr<NPC>> NPCFactory::loadFromFile(const std::string& filename){
+std::vector<std::shared_ptr<NPC>> NPCFactory::loadFromFile(const std::string& filename, bool verbose){
     std::vector<std::shared_ptr<NPC>> loadedNPCs;
     std::ifstream file(filename);
     if (!file.is_open()){
         std::cerr << "Error: Cannot open file " << filename << " for reading" << std::endl;
         return loadedNPCs;
     }
-    std::string line;
-    while (std::getline(file, line)){
-        std::stringstream ss(line);
-        std::string typeStr, name;
-        double x, y;
-        if (std::getline(ss, typeStr, ',') && std::getline(ss, name, ',') && (ss >> x) && ss.ignore() && (ss >> y)) {
-            NPCType type = stringToType(typeStr);
-            auto npc = createNPC(type, name, x, y);
-            if (npc){
-                loadedNPCs.push_back(npc);
+    loadedNPCs = parseStream(file);
+    file.close();
+    if (verbose) std::cout << "Loaded " << loadedNPCs.size() << " NPCs from " << filename << std::endl;
+    return loadedNPCs;
+}
+bool NPCFactory::saveToFileSharded(const std::vector<std::shared_ptr<NPC>>& npcs, const std::string& manifestFilename, size_t shardCount, bool verbose){
+    return saveRowsSharded(npcs.size(), [&npcs](std::ostream& out, size_t i){
+        if (npcs[i]->isAlive()) {
+            writeRecord(out, *npcs[i]);
+        }
+    }, manifestFilename, shardCount, verbose);
+}
+bool NPCFactory::saveRowsSharded(size_t rowCount, const std::function<void(std::ostream&, size_t)>& writeRow,
+                                 const std::string& manifestFilename, size_t shardCount, bool verbose){
+    if (shardCount == 0) {
+        shardCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::filesystem::path manifestPath(manifestFilename);
+    std::vector<std::string> shardNames(shardCount);
+    std::vector<char> written(shardCount, 0);
+    std::vector<std::thread> workers;
+    workers.reserve(shardCount);
+    // Contiguous slices keep the original NPC order across the shards.
+    for (size_t shard = 0; shard < shardCount; shard++){
+        shardNames[shard] = manifestPath.filename().string() + ".shard" + std::to_string(shard);
+        size_t begin = rowCount * shard / shardCount;
+        size_t end = rowCount * (shard + 1) / shardCount;
+        std::filesystem::path shardPath = manifestPath.parent_path() / shardNames[shard];
+        workers.emplace_back([&writeRow, &written, shard, begin, end, shardPath](){
+            std::ostringstream buffer;
+            for (size_t i = begin; i < end; i++){
+                writeRow(buffer, i);
+            }
+            std::ofstream file(shardPath, std::ios::binary);
+            if (!file.is_open()){
+                std::cerr << "Error: Cannot open file " << shardPath.string() << " for writing" << std::endl;
+                return;
             }
+            const std::string data = buffer.str();
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            written[shard] = file.good() ? 1 : 0;
+        });
+    }
+    for (auto& worker : workers){
+        worker.join();
+    }
+    if (std::find(written.begin(), written.end(), 0) != written.end()) {
+        return false;
+    }
+    std::ofstream manifest(manifestFilename);
+    if (!manifest.is_open()){
+        std::cerr << "Error: Cannot open file " << manifestFilename << " for writing" << std::endl;
+        return false;
+    }
+    manifest << kManifestTag << " " << shardCount << "\n";
+    for (const auto& shardName : shardNames){
+        manifest << shardName << "\n";
+    }
+    manifest.close();
+    if (verbose) std::cout << "Saved " << rowCount << " NPCs to " << manifestFilename << " (" << shardCount << " shards)" << std::endl;
+    return true;
+}
+std::vector<std::shared_ptr<NPC>> NPCFactory::loadFromFileSharded(const std::string& manifestFilename, bool verbose){
+    std::vector<std::shared_ptr<NPC>> loadedNPCs;
+    std::ifstream manifest(manifestFilename);
+    if (!manifest.is_open()){
+        std::cerr << "Error: Cannot open file " << manifestFilename << " for reading" << std::endl;
+        return loadedNPCs;
+    }
+    std::string tag;
+    size_t shardCount = 0;
+    if (!(manifest >> tag >> shardCount) || tag != kManifestTag) {
+        std::cerr << "Error: " << manifestFilename << " is not a shard manifest" << std::endl;
+        return loadedNPCs;
+    }
+    std::filesystem::path directory = std::filesystem::path(manifestFilename).parent_path();
+    std::vector<std::filesystem::path> shardPaths;
+    std::string shardName;
+    std::getline(manifest, shardName);
+    while (shardPaths.size() < shardCount && std::getline(manifest, shardName)){
+        if (!shardName.empty()) shardPaths.push_back(directory / shardName);
+    }
+    if (shardPaths.size() != shardCount) {
+        std::cerr << "Error: Manifest " << manifestFilename << " lists " << shardPaths.size()
+                  << " of " << shardCount << " shards" << std::endl;
+        return loadedNPCs;
+    }
+
+    std::vector<std::vector<std::shared_ptr<NPC>>> shards(shardCount);
+    std::vector<char> opened(shardCount, 0);
+    std::vector<std::thread> workers;
+    workers.reserve(shardCount);
+    for (size_t shard = 0; shard < shardCount; shard++){
+        workers.emplace_back([&shards, &opened, &shardPaths, shard](){
+            std::ifstream file(shardPaths[shard]);
+            if (!file.is_open()){
+                std::cerr << "Error: Cannot open file " << shardPaths[shard].string() << " for reading" << std::endl;
+                return;
+            }
+            shards[shard] = parseStream(file);
+            opened[shard] = 1;
+        });
+    }
+    for (auto& worker : workers){
+        worker.join();
+    }
+    if (std::find(opened.begin(), opened.end(), 0) != opened.end()) {
+        return loadedNPCs;
+    }
+
+    // Names must stay unique across shards, as DungeonEditor::addNPC enforces.
+    size_t total = 0;
+    for (const auto& shard : shards){
+        total += shard.size();
+    }
+    loadedNPCs.reserve(total);
+    std::unordered_set<std::string> names;
+    names.reserve(total);
+    for (auto& shard : shards){
+        for (auto& npc : shard){
+            if (!names.insert(npc->getName()).second) {
+                std::cerr << "Error: NPC with name '" << npc->getName() << "' already exists" << std::endl;
+                continue;
+            }
+            loadedNPCs.push_back(std::move(npc));
         }
     }
-    file.close();
-    std::cout << "Loaded " << loadedNPCs.size() << " NPCs from " << filename << std::endl;
+    if (verbose) std::cout << "Loaded " << loadedNPCs.size() << " NPCs from " << manifestFilename << " (" << shardCount << " shards)" << std::endl;
     return loadedNPCs;
 }
 NPCFactory::NPCType NPCFactory::stringToType(const std::string& typeStr){
-    if (typeStr == "SQUIRREL") return NPCType::SQUIRREL;
-    if (typeStr == "WEREWOLF") return NPCType::WEREWOLF;
-    if (typeStr == "DRUID") return NPCType::DRUID;
+    if (typeStr == "SQUIRREL" || typeStr == "Squirrel") return NPCType::SQUIRREL;
+    if (typeStr == "WEREWOLF" || typeStr == "Werewolf") return NPCType::WEREWOLF;
+    if (typeStr == "DRUID" || typeStr == "Druid") return NPCType::DRUID;
     return NPCType::SQUIRREL;
 }
 std::string NPCFactory::typeToString(NPCType type){
@@ -18,6 +18,13 @@ void BattleSubject::notify(const std::string& event){
         observer->update(event);
     }
 }
+size_t BattleSubject::memoryUsage() const{
+    size_t bytes = observers.capacity() * sizeof(BattleObserver*);
+    for (auto observer : observers) {
+        bytes += observer->memoryUsage();
+    }
+    return bytes;
+}
 void ConsoleLogger::update(const std::string& event){
     std::time_t now = std::time(nullptr);
     std::tm* timeinfo = std::localtime(&now);
@@ -39,6 +46,9 @@ void FileLogger::update(const std::string& event){
         file.close();
     }
 }
+size_t FileLogger::memoryUsage() const{
+    return filename.capacity() > std::string().capacity() ? filename.capacity() + 1 : 0;
+}
 void BattleLogger::logBattleEvent(const std::string& event){
     notify(event);
 }
\ No newline at end of file
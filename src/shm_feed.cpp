@@ -0,0 +1,246 @@
+#include "../include/shm_feed.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory feed needs address-free 64-bit atomics");
+
+struct ShmFeedHeader{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    int32_t writerPid;
+    alignas(64) std::atomic<uint64_t> published;
+};
+
+namespace {
+
+const uint64_t kFeedMagic = 0x4E50434645454431ULL;
+const uint32_t kFeedVersion = 1;
+
+// Slot layout: sequence, timestamp, length, then the event text. A sequence
+// of 0 means the slot is being rewritten.
+struct ShmFeedSlot{
+    std::atomic<uint64_t> sequence;
+    int64_t timestampNs;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+size_t slotsOffset(){
+    return (sizeof(ShmFeedHeader) + 63) / 64 * 64;
+}
+
+size_t mappingSize(uint32_t slotCount, uint32_t slotSize){
+    return slotsOffset() + static_cast<size_t>(slotCount) * slotSize;
+}
+
+ShmFeedSlot* slotAt(const ShmFeedHeader* header, uint32_t slotCount, uint32_t slotSize, uint64_t sequence){
+    size_t index = static_cast<size_t>((sequence - 1) % slotCount);
+    char* base = reinterpret_cast<char*>(const_cast<ShmFeedHeader*>(header)) + slotsOffset();
+    return reinterpret_cast<ShmFeedSlot*>(base + index * slotSize);
+}
+
+char* slotText(ShmFeedSlot* slot){
+    return reinterpret_cast<char*>(slot) + sizeof(ShmFeedSlot);
+}
+
+// True if `name` holds a finished feed whose writer process no longer exists,
+// e.g. after the writer was killed before its destructor could unlink it.
+bool isStaleFeed(const std::string& name){
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat info;
+    void* memory = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(ShmFeedHeader)) {
+        memory = mmap(nullptr, sizeof(ShmFeedHeader), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (memory == MAP_FAILED) return false;
+    const ShmFeedHeader* header = static_cast<const ShmFeedHeader*>(memory);
+    bool stale = header->magic == kFeedMagic && header->writerPid > 0 &&
+                 kill(header->writerPid, 0) != 0 && errno == ESRCH;
+    munmap(memory, sizeof(ShmFeedHeader));
+    return stale;
+}
+
+}
+
+SharedMemoryLogger::SharedMemoryLogger(const std::string& name, uint32_t slotCount, uint32_t slotSize) : name(name){
+    slotSize = std::max<uint32_t>(slotSize, sizeof(ShmFeedSlot) + 8);
+    slotSize = (slotSize + 7) / 8 * 8;
+    slotCount = std::max<uint32_t>(slotCount, 1);
+    size_t bytes = mappingSize(slotCount, slotSize);
+
+    // O_EXCL: never take over a feed another writer is still publishing to.
+    // A feed left behind by a writer that died is unlinked and recreated.
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST && isStaleFeed(name)) {
+        std::cerr << "Warning: Replacing stale shared memory " << name << " left by a dead writer" << std::endl;
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0 && errno == EEXIST) {
+        std::cerr << "Error: Shared memory " << name << " is already in use" << std::endl;
+        return;
+    }
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        std::cerr << "Error: Cannot size shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(name.c_str());
+        return;
+    }
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: Cannot map shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return;
+    }
+    std::memset(memory, 0, bytes);
+    header = new (memory) ShmFeedHeader{};
+    header->version = kFeedVersion;
+    header->slotCount = slotCount;
+    header->slotSize = slotSize;
+    header->writerPid = static_cast<int32_t>(getpid());
+    header->published.store(0, std::memory_order_relaxed);
+    for (uint64_t sequence = 1; sequence <= slotCount; sequence++){
+        new (slotAt(header, slotCount, slotSize, sequence)) ShmFeedSlot{};
+    }
+    // Readers check the magic before trusting anything else in the header.
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kFeedMagic;
+    mappedBytes = bytes;
+    this->slotCount = slotCount;
+    this->slotSize = slotSize;
+}
+SharedMemoryLogger::~SharedMemoryLogger(){
+    if (header) {
+        munmap(header, mappedBytes);
+        shm_unlink(name.c_str());
+    }
+}
+bool SharedMemoryLogger::isOpen() const{
+    return header != nullptr;
+}
+void SharedMemoryLogger::update(const std::string& event){
+    if (!header) return;
+    uint64_t sequence = header->published.load(std::memory_order_relaxed) + 1;
+    ShmFeedSlot* slot = slotAt(header, slotCount, slotSize, sequence);
+    size_t capacity = slotSize - sizeof(ShmFeedSlot);
+    uint32_t length = static_cast<uint32_t>(std::min(event.size(), capacity));
+
+    slot->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    slot->length = length;
+    std::memcpy(slotText(slot), event.data(), length);
+    slot->sequence.store(sequence, std::memory_order_release);
+    header->published.store(sequence, std::memory_order_release);
+}
+uint64_t SharedMemoryLogger::getSequence() const{
+    return header ? header->published.load(std::memory_order_acquire) : 0;
+}
+size_t SharedMemoryLogger::memoryUsage() const{
+    return mappedBytes + (name.capacity() > std::string().capacity() ? name.capacity() + 1 : 0);
+}
+
+SharedMemoryFeedReader::SharedMemoryFeedReader(const std::string& name, bool fromOldest){
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < slotsOffset()) {
+        std::cerr << "Error: Shared memory " << name << " is not a battle feed" << std::endl;
+        close(fd);
+        return;
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* memory = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: Cannot map shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    const ShmFeedHeader* candidate = static_cast<const ShmFeedHeader*>(memory);
+    bool valid = candidate->magic == kFeedMagic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t count = candidate->slotCount;
+    uint32_t size = candidate->slotSize;
+    valid = valid && candidate->version == kFeedVersion && count > 0 &&
+            size > sizeof(ShmFeedSlot) && mappingSize(count, size) <= bytes;
+    if (!valid) {
+        std::cerr << "Error: Shared memory " << name << " is not a battle feed" << std::endl;
+        munmap(memory, bytes);
+        return;
+    }
+    header = candidate;
+    mappedBytes = bytes;
+    slotCount = count;
+    slotSize = size;
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    if (!fromOldest) {
+        nextSequence = published + 1;
+    } else if (published >= slotCount) {
+        nextSequence = published - slotCount + 1;
+    }
+}
+SharedMemoryFeedReader::~SharedMemoryFeedReader(){
+    if (header) {
+        munmap(const_cast<ShmFeedHeader*>(header), mappedBytes);
+    }
+}
+bool SharedMemoryFeedReader::isOpen() const{
+    return header != nullptr;
+}
+size_t SharedMemoryFeedReader::poll(std::vector<FeedEvent>& events, size_t maxEvents){
+    if (!header) return 0;
+    size_t lost = 0;
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    if (published >= nextSequence + slotCount) {
+        uint64_t oldest = published - slotCount + 1;
+        lost += static_cast<size_t>(oldest - nextSequence);
+        nextSequence = oldest;
+    }
+    size_t capacity = slotSize - sizeof(ShmFeedSlot);
+    size_t taken = 0;
+    while (nextSequence <= published && taken < maxEvents){
+        ShmFeedSlot* slot = slotAt(header, slotCount, slotSize, nextSequence);
+        uint64_t sequence = nextSequence++;
+        if (slot->sequence.load(std::memory_order_acquire) != sequence) {
+            lost++;
+            continue;
+        }
+        FeedEvent event{sequence, slot->timestampNs, {}};
+        event.text.assign(slotText(slot), std::min<size_t>(slot->length, capacity));
+        // The writer may have lapped us while we copied; then the copy is torn.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) != sequence) {
+            lost++;
+            continue;
+        }
+        events.push_back(std::move(event));
+        taken++;
+    }
+    return lost;
+}
+uint64_t SharedMemoryFeedReader::getNextSequence() const{
+    return nextSequence;
+}
@@ -0,0 +1,384 @@
+#include "../include/tiled_world.h"
+#include "../include/npc_factory.h"
+#include "../include/visitor.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const uint64_t kTileMagic = 0x4E504354494C4531ULL;
+const uint32_t kTileVersion = 1;
+
+struct TileFileHeader{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint64_t nameBytes;
+};
+
+struct TileRecord{
+    double x;
+    double y;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint8_t type;
+    uint8_t reserved[7];
+};
+
+}
+
+TiledWorld::TiledWorld(const std::string& directory, size_t tilesX, size_t tilesY, size_t maxResidentTiles)
+    : directory(directory), tilesX(std::max<size_t>(tilesX, 1)), tilesY(std::max<size_t>(tilesY, 1)),
+      maxResidentTiles(std::max<size_t>(maxResidentTiles, 1)), tileCounts(this->tilesX * this->tilesY, 0){
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Error: Cannot create world directory " << directory << ": " << error.message() << std::endl;
+        return;
+    }
+    // Only the headers of existing snapshots are read up front.
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)){
+        size_t tx = 0, ty = 0;
+        std::string filename = entry.path().filename().string();
+        if (std::sscanf(filename.c_str(), "tile_%zu_%zu.bin", &tx, &ty) != 2 || tx >= this->tilesX || ty >= this->tilesY) continue;
+        std::ifstream file(entry.path(), std::ios::binary);
+        TileFileHeader header{};
+        if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == kTileMagic) {
+            tileCounts[keyOf(tx, ty)] = header.count;
+        }
+    }
+}
+TiledWorld::~TiledWorld(){
+    flush();
+}
+
+size_t TiledWorld::keyOf(size_t tx, size_t ty) const{
+    return ty * tilesX + tx;
+}
+std::string TiledWorld::tilePath(size_t key) const{
+    return (std::filesystem::path(directory) /
+            ("tile_" + std::to_string(key % tilesX) + "_" + std::to_string(key / tilesX) + ".bin")).string();
+}
+
+bool TiledWorld::writeSnapshot(size_t key, const DungeonEditor& editor) const{
+    std::vector<std::shared_ptr<NPC>> materialized;
+    const auto* npcs = &editor.npcs;
+    if (editor.isCompactMode()) {
+        materialized = editor.compactStore.materialize();
+        npcs = &materialized;
+    }
+    std::vector<TileRecord> records;
+    std::string names;
+    records.reserve(npcs->size());
+    for (const auto& npc : *npcs){
+        if (!npc->isAlive()) continue;
+        TileRecord record{};
+        record.x = npc->getX();
+        record.y = npc->getY();
+        record.nameOffset = static_cast<uint32_t>(names.size());
+        record.nameLength = static_cast<uint32_t>(npc->getName().size());
+        record.type = static_cast<uint8_t>(NPCFactory::stringToType(npc->getType()));
+        names += npc->getName();
+        records.push_back(record);
+    }
+    TileFileHeader header{kTileMagic, kTileVersion, static_cast<uint32_t>(records.size()), names.size()};
+
+    std::string path = tilePath(key);
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()){
+        std::cerr << "Error: Cannot open file " << temporary << " for writing" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(TileRecord)));
+    file.write(names.data(), static_cast<std::streamsize>(names.size()));
+    file.close();
+    if (!file || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: Cannot write tile snapshot " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TiledWorld::readSnapshot(size_t key, DungeonEditor& editor) const{
+    std::string path = tilePath(key);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return errno == ENOENT;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(TileFileHeader)) {
+        close(fd);
+        std::cerr << "Error: " << path << " is not a tile snapshot" << std::endl;
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* memory = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: Cannot map tile snapshot " << path << std::endl;
+        return false;
+    }
+    const char* base = static_cast<const char*>(memory);
+    TileFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    size_t expected = sizeof(header) + header.count * sizeof(TileRecord) + header.nameBytes;
+    bool valid = header.magic == kTileMagic && header.version == kTileVersion && expected <= bytes;
+    // Decode everything first so a damaged file never yields a partial tile.
+    std::vector<std::shared_ptr<NPC>> decoded;
+    if (valid) {
+        const char* names = base + sizeof(header) + header.count * sizeof(TileRecord);
+        decoded.reserve(header.count);
+        for (uint32_t i = 0; i < header.count; i++){
+            TileRecord record;
+            std::memcpy(&record, base + sizeof(header) + i * sizeof(TileRecord), sizeof(record));
+            if (record.type > static_cast<uint8_t>(NPCFactory::NPCType::DRUID) ||
+                static_cast<uint64_t>(record.nameOffset) + record.nameLength > header.nameBytes) {
+                valid = false;
+                break;
+            }
+            auto npc = NPCFactory::createNPC(static_cast<NPCFactory::NPCType>(record.type),
+                                             std::string(names + record.nameOffset, record.nameLength), record.x, record.y);
+            if (!npc) {
+                valid = false;
+                break;
+            }
+            decoded.push_back(npc);
+        }
+    }
+    munmap(memory, bytes);
+    if (!valid) {
+        std::cerr << "Error: " << path << " is not a tile snapshot" << std::endl;
+        return false;
+    }
+    editor.npcs.insert(editor.npcs.end(), decoded.begin(), decoded.end());
+    return true;
+}
+
+DungeonEditor& TiledWorld::load(size_t key){
+    auto it = resident.find(key);
+    if (it != resident.end()) {
+        lru.splice(lru.begin(), lru, it->second.lruPosition);
+        return *it->second.editor;
+    }
+    while (resident.size() >= maxResidentTiles){
+        evict(lru.back());
+    }
+    auto editor = std::make_unique<DungeonEditor>();
+    editor->setQuiet(true);
+    if (!readSnapshot(key, *editor)) {
+        damagedTiles.insert(key);
+    }
+    lru.push_front(key);
+    auto& tile = resident[key];
+    tile.editor = std::move(editor);
+    tile.lruPosition = lru.begin();
+    return *tile.editor;
+}
+
+bool TiledWorld::saveTile(size_t key, const DungeonEditor& editor) const{
+    if (damagedTiles.count(key)) {
+        std::cerr << "Error: Tile snapshot " << tilePath(key) << " is damaged; changes to this tile are not saved" << std::endl;
+        return false;
+    }
+    return writeSnapshot(key, editor);
+}
+
+bool TiledWorld::evict(size_t key){
+    auto it = resident.find(key);
+    if (it == resident.end()) return true;
+    bool saved = saveTile(key, *it->second.editor);
+    if (!damagedTiles.count(key)) {
+        tileCounts[key] = static_cast<uint32_t>(it->second.editor->getNPCCount());
+    }
+    lru.erase(it->second.lruPosition);
+    resident.erase(it);
+    return saved;
+}
+
+bool TiledWorld::flush(){
+    bool saved = true;
+    for (const auto& [key, tile] : resident){
+        saved = saveTile(key, *tile.editor) && saved;
+        if (!damagedTiles.count(key)) {
+            tileCounts[key] = static_cast<uint32_t>(tile.editor->getNPCCount());
+        }
+    }
+    return saved;
+}
+
+bool TiledWorld::addNPC(const std::string& type, const std::string& name, double x, double y){
+    if (!(x > 0 && x <= tilesX * kTileSize && y > 0 && y <= tilesY * kTileSize)) {
+        std::cerr << "Error: Coordinates must be in range (0 < x <= " << tilesX * kTileSize
+                  << ", 0 < y <= " << tilesY * kTileSize << ")" << std::endl;
+        return false;
+    }
+    size_t tx = std::min(tilesX - 1, static_cast<size_t>(std::ceil(x / kTileSize)) - 1);
+    size_t ty = std::min(tilesY - 1, static_cast<size_t>(std::ceil(y / kTileSize)) - 1);
+    DungeonEditor& editor = tile(tx, ty);
+    if (damagedTiles.count(keyOf(tx, ty))) {
+        std::cerr << "Error: Tile snapshot " << tilePath(keyOf(tx, ty)) << " is damaged; cannot add NPC" << std::endl;
+        return false;
+    }
+    return editor.addNPC(type, name, x - tx * kTileSize, y - ty * kTileSize);
+}
+
+DungeonEditor& TiledWorld::tile(size_t tx, size_t ty){
+    return load(keyOf(std::min(tx, tilesX - 1), std::min(ty, tilesY - 1)));
+}
+
+std::vector<TiledWorld::BattleEntry> TiledWorld::collect(size_t key, double range, size_t ownerKey){
+    std::vector<BattleEntry> entries;
+    DungeonEditor& editor = load(key);
+    // Compact tiles are read through temporary objects and stay compact;
+    // indexes still match the store's order.
+    std::vector<std::shared_ptr<NPC>> materialized;
+    const auto* npcs = &editor.npcs;
+    if (editor.isCompactMode()) {
+        materialized = editor.compactStore.materialize();
+        npcs = &materialized;
+    }
+    // Position of this tile relative to the owner tile's origin.
+    double offsetX = (static_cast<double>(key % tilesX) - static_cast<double>(ownerKey % tilesX)) * kTileSize;
+    double offsetY = (static_cast<double>(key / tilesX) - static_cast<double>(ownerKey / tilesX)) * kTileSize;
+    for (size_t i = 0; i < npcs->size(); i++){
+        const auto& npc = (*npcs)[i];
+        if (!npc->isAlive()) continue;
+        if (key != ownerKey) {
+            double x = offsetX + npc->getX();
+            double y = offsetY + npc->getY();
+            double dx = std::max({0.0, -x, x - kTileSize});
+            double dy = std::max({0.0, -y, y - kTileSize});
+            if (dx * dx + dy * dy > range * range) continue;
+        }
+        entries.push_back({npc, key, i});
+    }
+    return entries;
+}
+
+size_t TiledWorld::startBattle(double range){
+    std::vector<TileCoord> all;
+    for (size_t key = 0; key < tileCounts.size(); key++){
+        if (tileCounts[key] > 0 || resident.count(key)) {
+            all.push_back({key % tilesX, key / tilesX});
+        }
+    }
+    return startBattle(range, all);
+}
+
+size_t TiledWorld::startBattle(double range, const std::vector<TileCoord>& activeTiles){
+    std::set<size_t> active;
+    for (const auto& [tx, ty] : activeTiles){
+        if (tx < tilesX && ty < tilesY) active.insert(keyOf(tx, ty));
+    }
+    long ring = std::max(1L, static_cast<long>(std::ceil(range / kTileSize)));
+
+    // Phase 1: decide every kill against the state before the battle. A pair
+    // across a border belongs to the lower active tile, so it is seen once.
+    std::unordered_map<size_t, std::vector<size_t>> victims;
+    std::vector<std::string> events;
+    for (size_t key : active){
+        if (getTileNPCCount(key % tilesX, key / tilesX) == 0) continue;
+        std::vector<BattleEntry> own = collect(key, range, key);
+        std::vector<BattleEntry> ghosts;
+        long tx = static_cast<long>(key % tilesX);
+        long ty = static_cast<long>(key / tilesX);
+        for (long ny = ty - ring; ny <= ty + ring; ny++){
+            for (long nx = tx - ring; nx <= tx + ring; nx++){
+                if (nx < 0 || ny < 0 || nx >= static_cast<long>(tilesX) || ny >= static_cast<long>(tilesY)) continue;
+                size_t neighbour = keyOf(static_cast<size_t>(nx), static_cast<size_t>(ny));
+                if (neighbour == key || (active.count(neighbour) && neighbour < key)) continue;
+                if (getTileNPCCount(static_cast<size_t>(nx), static_cast<size_t>(ny)) == 0) continue;
+                auto entries = collect(neighbour, range, key);
+                ghosts.insert(ghosts.end(), entries.begin(), entries.end());
+            }
+        }
+
+        auto resolve = [&](const BattleEntry& first, const BattleEntry& second){
+            double dx = (static_cast<double>(first.tileKey % tilesX) - static_cast<double>(second.tileKey % tilesX)) * kTileSize
+                        + (first.npc->getX() - second.npc->getX());
+            double dy = (static_cast<double>(first.tileKey / tilesX) - static_cast<double>(second.tileKey / tilesX)) * kTileSize
+                        + (first.npc->getY() - second.npc->getY());
+            if (std::sqrt(dx * dx + dy * dy) > range) return;
+            bool firstCan = first.npc->canAttack(second.npc.get());
+            bool secondCan = second.npc->canAttack(first.npc.get());
+            if (!firstCan && !secondCan) return;
+            if (secondCan) victims[first.tileKey].push_back(first.index);
+            if (firstCan) victims[second.tileKey].push_back(second.index);
+            events.push_back(battleEventText(first.npc->getName(), first.npc->getType(),
+                                             second.npc->getName(), second.npc->getType(), firstCan, secondCan));
+        };
+        for (size_t i = 0; i < own.size(); i++){
+            for (size_t j = i + 1; j < own.size(); j++){
+                resolve(own[i], own[j]);
+            }
+            for (const auto& ghost : ghosts){
+                resolve(own[i], ghost);
+            }
+        }
+    }
+    for (const auto& event : events){
+        battleLogger.logBattleEvent(event);
+    }
+
+    // Phase 2: apply the kills tile by tile.
+    size_t killed = 0;
+    for (auto& [key, indexes] : victims){
+        std::sort(indexes.begin(), indexes.end());
+        indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+        DungeonEditor& editor = load(key);
+        if (editor.isCompactMode()) {
+            auto npcs = editor.compactStore.materialize();
+            for (size_t index : indexes){
+                npcs[index]->setAlive(false);
+            }
+            editor.compactStore.assign(npcs);
+        } else {
+            for (size_t index : indexes){
+                editor.npcs[index]->setAlive(false);
+            }
+            editor.npcs.erase(std::remove_if(editor.npcs.begin(), editor.npcs.end(),
+                [](const std::shared_ptr<NPC>& npc) {
+                    return !npc->isAlive();
+                }), editor.npcs.end());
+        }
+        tileCounts[key] = static_cast<uint32_t>(editor.getNPCCount());
+        killed += indexes.size();
+    }
+    return killed;
+}
+
+size_t TiledWorld::getNPCCount() const{
+    size_t total = 0;
+    for (size_t key = 0; key < tileCounts.size(); key++){
+        total += getTileNPCCount(key % tilesX, key / tilesX);
+    }
+    return total;
+}
+size_t TiledWorld::getTileNPCCount(size_t tx, size_t ty) const{
+    size_t key = keyOf(tx, ty);
+    auto it = resident.find(key);
+    return it != resident.end() ? it->second.editor->getNPCCount() : tileCounts[key];
+}
+size_t TiledWorld::getResidentTileCount() const{
+    return resident.size();
+}
+size_t TiledWorld::getTilesX() const{
+    return tilesX;
+}
+size_t TiledWorld::getTilesY() const{
+    return tilesY;
+}
+BattleLogger& TiledWorld::getBattleLogger(){
+    return battleLogger;
+}
@@ -3,6 +3,24 @@
 #include "../include/observer.h"
 #include <iostream>
 #include <algorithm>
+#include <barrier>
+#include <thread>
+#include <unordered_map>
+
+std::string battleEventText(std::string_view name1, std::string_view type1,
+                            std::string_view name2, std::string_view type2, bool npc1Can, bool npc2Can){
+    std::string event;
+    if (npc1Can && npc2Can){
+        event.append(name1).append("and").append(name2).append("killed each other");
+    }
+    else if (npc1Can){
+        event.append(name1).append(" (").append(type1).append(") killed ").append(name2).append(" (").append(type2).append(")");
+    }
+    else if (npc2Can){
+        event.append(name2).append(" (").append(type2).append(") killed ").append(name1).append(" (").append(type1).append(")");
+    }
+    return event;
+}
 
 BattleVisitor::BattleVisitor(std::vector<std::shared_ptr<NPC>>& npcs, double range, BattleLogger* logger) : npcs(npcs), battleRange(range), logger(logger){}
 void BattleVisitor::visit(Squirrel* squirrel){
@@ -29,44 +47,130 @@ void BattleVisitor::visit(Druid* druid){
 }
 
 void BattleVisitor::resolveBattle(NPC* npc1, NPC* npc2) {
+    std::string event = resolvePair(npc1, npc2);
+    if (logger && !event.empty()) logger->logBattleEvent(event);
+}
+
+std::string BattleVisitor::resolvePair(NPC* npc1, NPC* npc2) {
     bool npc1Can = npc1->canAttack(npc2);
     bool npc2Can = npc2->canAttack(npc1);
-    std:: string event;
-    if (npc1Can && npc2Can){
-        npc1->setAlive(false);
-        npc2->setAlive(false);
-        event = npc1->getName() + "and" + npc2->getName() + "killed each other";
-        if (logger) logger->logBattleEvent(event);
-    }
-    else if (npc1Can){
-        npc2->setAlive(false);
-        event = npc1->getName() + " (" + npc1->getType() + ") killed " + npc2->getName() + " (" + npc2->getType() + ")"; 
-        if (logger) logger->logBattleEvent(event);
-    }
-    else if (npc2Can){
-        npc1->setAlive(false);
-        event = npc2->getName() + " (" + npc2->getType() + ") killed " + npc1->getName() + " (" + npc1->getType() + ")"; 
-        if (logger) logger->logBattleEvent(event);
-    }
+    if (!npc1Can && !npc2Can) return "";
+    if (npc2Can) npc1->setAlive(false);
+    if (npc1Can) npc2->setAlive(false);
+    return battleEventText(npc1->getName(), npc1->getType(), npc2->getName(), npc2->getType(), npc1Can, npc2Can);
 }
 
-void BattleVisitor::executeBattle(){
+std::vector<std::pair<NPC*, NPC*>> BattleVisitor::findPairs(size_t threadCount) const{
     std::vector<std::pair<NPC*, NPC*>> battlePairs;
-    for (size_t i = 0; i < npcs.size(); i++){
-        if (!npcs[i]->isAlive()) continue;
+    auto scanRow = [this](size_t i, std::vector<std::pair<NPC*, NPC*>>& out){
+        if (!npcs[i]->isAlive()) return;
         for (size_t j = i + 1; j < npcs.size(); j++){
             if (!npcs[j]->isAlive()) continue;
             double distance = npcs[i]->calculateDistance(npcs[j].get());
             if (distance <= battleRange) {
-                battlePairs.push_back({npcs[i].get(), npcs[j].get()});
+                out.push_back({npcs[i].get(), npcs[j].get()});
             }
         }
+    };
+    if (threadCount <= 1) {
+        for (size_t i = 0; i < npcs.size(); i++){
+            scanRow(i, battlePairs);
+        }
+        return battlePairs;
     }
-    for (auto& pair : battlePairs) {
-        resolveBattle(pair.first, pair.second);
+    // Rows are dealt round-robin so the shrinking inner loop stays balanced,
+    // then concatenated in row order to match the sequential pair order.
+    std::vector<std::vector<std::pair<NPC*, NPC*>>> rows(npcs.size());
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threadCount; t++){
+        workers.emplace_back([&scanRow, &rows, t, threadCount, this](){
+            for (size_t i = t; i < npcs.size(); i += threadCount){
+                scanRow(i, rows[i]);
+            }
+        });
+    }
+    for (auto& worker : workers){
+        worker.join();
+    }
+    size_t total = 0;
+    for (const auto& row : rows){
+        total += row.size();
+    }
+    battlePairs.reserve(total);
+    for (const auto& row : rows){
+        battlePairs.insert(battlePairs.end(), row.begin(), row.end());
     }
+    return battlePairs;
+}
+
+std::vector<std::vector<size_t>> BattleVisitor::conflictFreeBatches(const std::vector<std::pair<NPC*, NPC*>>& pairs){
+    // A pair goes one batch after the latest batch either of its NPCs is in.
+    std::unordered_map<NPC*, size_t> nextBatch;
+    std::vector<size_t> batchOf(pairs.size());
+    size_t batchCount = 0;
+    for (size_t k = 0; k < pairs.size(); k++){
+        size_t& first = nextBatch[pairs[k].first];
+        size_t& second = nextBatch[pairs[k].second];
+        size_t batch = std::max(first, second);
+        batchOf[k] = batch;
+        first = second = batch + 1;
+        batchCount = std::max(batchCount, batch + 1);
+    }
+    std::vector<std::vector<size_t>> batches(batchCount);
+    for (size_t k = 0; k < pairs.size(); k++){
+        batches[batchOf[k]].push_back(k);
+    }
+    return batches;
+}
+
+void BattleVisitor::removeDead(){
     npcs.erase(std::remove_if(npcs.begin(), npcs.end(),
         [](const std::shared_ptr<NPC>& npc) {
             return !npc->isAlive();
         }), npcs.end());
-}
\ No newline at end of file
+}
+
+void BattleVisitor::executeBattle(){
+    std::vector<std::pair<NPC*, NPC*>> battlePairs = findPairs(1);
+    for (auto& pair : battlePairs) {
+        resolveBattle(pair.first, pair.second);
+    }
+    removeDead();
+}
+
+void BattleVisitor::executeBattleParallel(size_t threadCount){
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::pair<NPC*, NPC*>> battlePairs = findPairs(threadCount);
+    std::vector<std::vector<size_t>> batches = conflictFreeBatches(battlePairs);
+    std::vector<std::string> events(battlePairs.size());
+
+    std::barrier batchDone(static_cast<std::ptrdiff_t>(threadCount));
+    auto resolveBatches = [&](size_t worker){
+        for (const auto& batch : batches){
+            size_t begin = batch.size() * worker / threadCount;
+            size_t end = batch.size() * (worker + 1) / threadCount;
+            for (size_t k = begin; k < end; k++){
+                const auto& pair = battlePairs[batch[k]];
+                events[batch[k]] = resolvePair(pair.first, pair.second);
+            }
+            batchDone.arrive_and_wait();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threadCount; t++){
+        workers.emplace_back(resolveBatches, t);
+    }
+    resolveBatches(0);
+    for (auto& worker : workers){
+        worker.join();
+    }
+
+    if (logger) {
+        for (const auto& event : events){
+            if (!event.empty()) logger->logBattleEvent(event);
+        }
+    }
+    removeDead();
+}
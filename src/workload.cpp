@@ -0,0 +1,133 @@
+#include "../include/workload.h"
+#include "../include/dungeon_editor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// splitmix64: fixed output for a given seed on every platform, unlike the
+// implementation-defined std:: distributions.
+class SeededRandom{
+private:
+    uint64_t state;
+public:
+    explicit SeededRandom(uint64_t seed) : state(seed){}
+    uint64_t next(){
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    // [0, 1)
+    double uniform(){
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+    double gaussian(){
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+};
+
+// Maps [0, 1) onto the (0, 500] map side.
+double toCoordinate(double unit){
+    return 500.0 * (1.0 - unit);
+}
+
+double clampCoordinate(double value){
+    return std::clamp(value, 0.001, 500.0);
+}
+
+}
+
+WorkloadGenerator::WorkloadGenerator(const Config& config) : config(config){}
+
+std::vector<NPCSpec> WorkloadGenerator::generate() const{
+    std::vector<NPCSpec> specs;
+    specs.reserve(config.npcCount);
+    SeededRandom random(config.seed);
+
+    double squirrelWeight = std::max(config.squirrelWeight, 0.0);
+    double werewolfWeight = std::max(config.werewolfWeight, 0.0);
+    double druidWeight = std::max(config.druidWeight, 0.0);
+    double totalWeight = squirrelWeight + werewolfWeight + druidWeight;
+    if (totalWeight <= 0.0) {
+        squirrelWeight = werewolfWeight = druidWeight = 1.0;
+        totalWeight = 3.0;
+    }
+
+    std::vector<std::pair<double, double>> centers;
+    if (config.distribution == Distribution::CLUSTERED) {
+        size_t count = std::max<size_t>(config.clusterCount, 1);
+        for (size_t i = 0; i < count; i++){
+            centers.push_back({toCoordinate(random.uniform()), toCoordinate(random.uniform())});
+        }
+    }
+    double hotspotSize = std::clamp(config.hotspotSize, 0.001, 500.0);
+    double hotspotX = toCoordinate(random.uniform()) * (500.0 - hotspotSize) / 500.0;
+    double hotspotY = toCoordinate(random.uniform()) * (500.0 - hotspotSize) / 500.0;
+
+    for (size_t i = 0; i < config.npcCount; i++){
+        double pick = random.uniform() * totalWeight;
+        NPCFactory::NPCType type;
+        if (pick < squirrelWeight) {
+            type = NPCFactory::NPCType::SQUIRREL;
+        } else if (pick < squirrelWeight + werewolfWeight) {
+            type = NPCFactory::NPCType::WEREWOLF;
+        } else {
+            type = NPCFactory::NPCType::DRUID;
+        }
+
+        double x, y;
+        switch (config.distribution){
+            case Distribution::CLUSTERED: {
+                const auto& center = centers[static_cast<size_t>(random.next() % centers.size())];
+                x = clampCoordinate(center.first + random.gaussian() * config.clusterSpread);
+                y = clampCoordinate(center.second + random.gaussian() * config.clusterSpread);
+                break;
+            }
+            case Distribution::HOTSPOT:
+                if (random.uniform() < config.hotspotShare) {
+                    x = clampCoordinate(hotspotX + hotspotSize * (1.0 - random.uniform()));
+                    y = clampCoordinate(hotspotY + hotspotSize * (1.0 - random.uniform()));
+                    break;
+                }
+                [[fallthrough]];
+            case Distribution::UNIFORM:
+            default:
+                x = toCoordinate(random.uniform());
+                y = toCoordinate(random.uniform());
+                break;
+        }
+        specs.push_back({type, "NPC_" + std::to_string(i), x, y});
+    }
+    return specs;
+}
+
+size_t WorkloadGenerator::populate(DungeonEditor& editor) const{
+    size_t added = 0;
+    for (const auto& spec : generate()){
+        if (editor.addNPC(NPCFactory::typeToString(spec.type), spec.name, spec.x, spec.y)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+WorkloadGenerator::Distribution WorkloadGenerator::stringToDistribution(const std::string& str, bool* ok){
+    if (ok) *ok = true;
+    if (str == "uniform") return Distribution::UNIFORM;
+    if (str == "clustered") return Distribution::CLUSTERED;
+    if (str == "hotspot") return Distribution::HOTSPOT;
+    if (ok) *ok = false;
+    return Distribution::UNIFORM;
+}
+
+std::string WorkloadGenerator::distributionToString(Distribution distribution){
+    switch (distribution){
+        case Distribution::UNIFORM: return "uniform";
+        case Distribution::CLUSTERED: return "clustered";
+        case Distribution::HOTSPOT: return "hotspot";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <string>
+#include <vector>
+#include "../include/observer.h"
+
+// Keeps every battle event in delivery order.
+class RecordingObserver : public BattleObserver {
+public:
+    std::vector<std::string> events;
+    void update(const std::string& event) override { events.push_back(event); }
+};
+
+#endif
@@ -4,6 +4,20 @@
 #include "../include/visitor.h"
 #include "../include/observer.h"
 #include "../include/dungeon_editor.h"
+#include "../include/workload.h"
+#include "../include/compact_store.h"
+#include "../include/battle_analyzer.h"
+#include "../include/shm_feed.h"
+#include "../include/tiled_world.h"
+#include "../include/battle_harness.h"
+#include "test_support.h"
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <fstream>
 #include <filesystem>
 
@@ -215,6 +229,12 @@ TEST(ObserverTest, FileLoggerCreatesFile){
     remove(filename.c_str());
 }
 
+TEST(VisitorTest, BattleEventTextPutsKillerFirst){
+    EXPECT_EQ(battleEventText("Sq", "Squirrel", "Wolf", "Werewolf", true, false), "Sq (Squirrel) killed Wolf (Werewolf)");
+    EXPECT_EQ(battleEventText("Dru", "Druid", "Wolf", "Werewolf", false, true), "Wolf (Werewolf) killed Dru (Druid)");
+    EXPECT_EQ(battleEventText("A", "Druid", "B", "Druid", false, false), "");
+}
+
 TEST(ObserverTest, BattleLoggerNotifiesObservers){
     BattleLogger logger;
     
@@ -303,6 +323,10 @@ TEST(DungeonEditorTest, FileOperations) {
     
     EXPECT_TRUE(editor.loadFromFile(filename));
     EXPECT_EQ(editor.getNPCCount(), 3);
+
+    // Types survive the round trip: the squirrel still kills both neighbours.
+    editor.startBattle(500.0);
+    EXPECT_EQ(editor.getNPCCount(), 1);
     
     remove(filename.c_str());
 }
@@ -338,4 +362,758 @@ TEST(EdgeCasesTest, SameTypeNPCBattle){
     
     editor.startBattle(10.0);
     EXPECT_EQ(editor.getNPCCount(), 2);
-}
\ No newline at end of file
+}
+TEST(WorkloadTest, SameSeedSameDungeon){
+    WorkloadGenerator::Config config;
+    config.npcCount = 500;
+    config.seed = 7;
+    config.distribution = WorkloadGenerator::Distribution::CLUSTERED;
+    auto first = WorkloadGenerator(config).generate();
+    auto second = WorkloadGenerator(config).generate();
+    ASSERT_EQ(first.size(), 500);
+    ASSERT_EQ(first.size(), second.size());
+    for (size_t i = 0; i < first.size(); i++){
+        EXPECT_EQ(first[i].type, second[i].type);
+        EXPECT_EQ(first[i].name, second[i].name);
+        EXPECT_DOUBLE_EQ(first[i].x, second[i].x);
+        EXPECT_DOUBLE_EQ(first[i].y, second[i].y);
+    }
+    config.seed = 8;
+    auto other = WorkloadGenerator(config).generate();
+    EXPECT_NE(first[0].x, other[0].x);
+}
+
+TEST(WorkloadTest, CoordinatesAndMix){
+    WorkloadGenerator::Config config;
+    config.npcCount = 2000;
+    config.squirrelWeight = 0.0;
+    config.werewolfWeight = 1.0;
+    config.druidWeight = 3.0;
+    for (auto distribution : {WorkloadGenerator::Distribution::UNIFORM,
+                              WorkloadGenerator::Distribution::CLUSTERED,
+                              WorkloadGenerator::Distribution::HOTSPOT}) {
+        config.distribution = distribution;
+        size_t werewolves = 0;
+        for (const auto& spec : WorkloadGenerator(config).generate()){
+            EXPECT_TRUE(NPC::isValidCoordinates(spec.x, spec.y));
+            EXPECT_NE(spec.type, NPCFactory::NPCType::SQUIRREL);
+            if (spec.type == NPCFactory::NPCType::WEREWOLF) werewolves++;
+        }
+        EXPECT_GT(werewolves, 350);
+        EXPECT_LT(werewolves, 650);
+    }
+}
+
+TEST(WorkloadTest, PopulateEditor){
+    WorkloadGenerator::Config config;
+    config.npcCount = 50;
+    config.distribution = WorkloadGenerator::Distribution::HOTSPOT;
+    DungeonEditor editor;
+    EXPECT_EQ(WorkloadGenerator(config).populate(editor), 50);
+    EXPECT_EQ(editor.getNPCCount(), 50);
+}
+
+TEST(CompactStoreTest, CoordinateEncoding){
+    EXPECT_DOUBLE_EQ(CompactNPCStore::decodeCoordinate(CompactNPCStore::encodeCoordinate(500.0)), 500.0);
+    EXPECT_GT(CompactNPCStore::decodeCoordinate(CompactNPCStore::encodeCoordinate(0.0001)), 0.0);
+    for (double value = 0.5; value <= 500.0; value += 3.7){
+        double decoded = CompactNPCStore::decodeCoordinate(CompactNPCStore::encodeCoordinate(value));
+        EXPECT_LE(std::abs(decoded - value), CompactNPCStore::kStep / 2);
+        EXPECT_TRUE(NPC::isValidCoordinates(decoded, decoded));
+    }
+}
+
+TEST(CompactStoreTest, TypeTagsAndNames){
+    CompactNPCStore store;
+    EXPECT_TRUE(store.add(NPCFactory::NPCType::DRUID, "Dru", 10, 20));
+    EXPECT_TRUE(store.add(NPCFactory::NPCType::SQUIRREL, "Sq", 30, 40));
+    EXPECT_TRUE(store.add(NPCFactory::NPCType::WEREWOLF, "Wolf", 50, 60));
+    EXPECT_FALSE(store.add(NPCFactory::NPCType::WEREWOLF, "Bad", 0, 60));
+    ASSERT_EQ(store.size(), 3);
+    EXPECT_EQ(store.getType(0), NPCFactory::NPCType::DRUID);
+    EXPECT_EQ(store.getType(1), NPCFactory::NPCType::SQUIRREL);
+    EXPECT_EQ(store.getType(2), NPCFactory::NPCType::WEREWOLF);
+    EXPECT_EQ(store.getName(2), "Wolf");
+    EXPECT_TRUE(store.contains("Sq"));
+    EXPECT_FALSE(store.contains("S"));
+}
+
+TEST(CompactStoreTest, CompactBattle){
+    DungeonEditor editor;
+    editor.setCompactMode(true);
+    editor.addNPC("squirrel", "Sq", 100, 100);
+    editor.addNPC("werewolf", "Wolf", 101, 101);
+    editor.addNPC("druid", "Dru", 102, 102);
+    editor.addNPC("druid", "FarDru", 400, 400);
+    editor.addNPC("werewolf", "FarWolf", 405, 400);
+    EXPECT_FALSE(editor.addNPC("druid", "Sq", 200, 200));
+    editor.startBattle(10.0);
+    EXPECT_EQ(editor.getNPCCount(), 2);
+
+    editor.setCompactMode(false);
+    EXPECT_EQ(editor.getNPCCount(), 2);
+    EXPECT_FALSE(editor.addNPC("druid", "FarWolf", 200, 200));
+    EXPECT_TRUE(editor.addNPC("druid", "FarDru", 200, 200));
+}
+
+TEST(CompactStoreTest, NegativeRangeBattlesNobody){
+    for (bool compact : {false, true}) {
+        DungeonEditor editor;
+        editor.setQuiet(true);
+        editor.setCompactMode(compact);
+        editor.addNPC("squirrel", "Sq", 100, 100);
+        editor.addNPC("druid", "Dru", 101, 100);
+        editor.startBattle(-5.0);
+        EXPECT_EQ(editor.getNPCCount(), 2) << "compact=" << compact;
+    }
+}
+
+TEST(CompactStoreTest, CompactFileOperations){
+    DungeonEditor editor;
+    editor.setCompactMode(true);
+    editor.addNPC("squirrel", "FileSq", 100, 200);
+    editor.addNPC("werewolf", "FileWolf", 150, 250);
+    editor.addNPC("druid", "FileDru", 200, 300);
+    string filename = "test_compact_dungeon.txt";
+    EXPECT_TRUE(editor.saveToFile(filename));
+    editor.clearAll();
+    EXPECT_TRUE(editor.loadFromFile(filename));
+    EXPECT_EQ(editor.getNPCCount(), 3);
+    editor.startBattle(500.0);
+    EXPECT_EQ(editor.getNPCCount(), 1);
+    remove(filename.c_str());
+}
+
+TEST(DungeonEditorTest, MemoryUsage){
+    DungeonEditor editor;
+    for (int i = 0; i < 100; i++){
+        editor.addNPC("druid", "A_rather_long_druid_name_" + to_string(i), 1.0 + i, 1.0 + i);
+    }
+    auto usage = editor.getMemoryUsage();
+    EXPECT_GE(usage.npcObjects, 100 * sizeof(Druid));
+    EXPECT_GE(usage.names, 100 * 26);
+    EXPECT_GE(usage.indexes, 100 * sizeof(shared_ptr<NPC>));
+    EXPECT_GT(usage.loggers, 0);
+    EXPECT_EQ(usage.total(), usage.npcObjects + usage.names + usage.indexes + usage.loggers);
+
+    editor.setCompactMode(true);
+    auto compact = editor.getMemoryUsage();
+    EXPECT_EQ(editor.getNPCCount(), 100);
+    EXPECT_EQ(compact.indexes, 0);
+    EXPECT_LT(compact.npcObjects, usage.npcObjects / 4);
+    EXPECT_LT(compact.total(), usage.total() / 2);
+}
+
+TEST(ShardedFileTest, RoundTripKeepsOrderAndTypes){
+    WorkloadGenerator::Config config;
+    config.npcCount = 1000;
+    auto specs = WorkloadGenerator(config).generate();
+    auto npcs = BattleHarness::buildNPCs(specs);
+    npcs[10]->setAlive(false);
+
+    string manifest = "test_sharded.manifest";
+    ASSERT_TRUE(NPCFactory::saveToFileSharded(npcs, manifest, 4));
+    auto loaded = NPCFactory::loadFromFileSharded(manifest);
+    auto single = vector<shared_ptr<NPC>>();
+    ASSERT_TRUE(NPCFactory::saveToFile(npcs, "test_sharded_single.txt"));
+    single = NPCFactory::loadFromFile("test_sharded_single.txt");
+
+    ASSERT_EQ(loaded.size(), 999);
+    ASSERT_EQ(loaded.size(), single.size());
+    for (size_t i = 0; i < loaded.size(); i++){
+        EXPECT_EQ(loaded[i]->getName(), single[i]->getName());
+        EXPECT_EQ(loaded[i]->getType(), single[i]->getType());
+        EXPECT_DOUBLE_EQ(loaded[i]->getX(), single[i]->getX());
+        EXPECT_DOUBLE_EQ(loaded[i]->getY(), single[i]->getY());
+    }
+    remove(manifest.c_str());
+    remove("test_sharded_single.txt");
+    for (int i = 0; i < 4; i++){
+        remove((manifest + ".shard" + to_string(i)).c_str());
+    }
+}
+
+TEST(ShardedFileTest, CompactStoreWritesSameShards){
+    WorkloadGenerator::Config config;
+    config.npcCount = 1000;
+    config.seed = 8;
+    CompactNPCStore store;
+    store.assign(BattleHarness::buildNPCs(WorkloadGenerator(config).generate()));
+    auto readShards = [](const string& manifest){
+        string data;
+        for (int i = 0; i < 3; i++){
+            ifstream file(manifest + ".shard" + to_string(i), ios::binary);
+            data += string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        }
+        return data;
+    };
+    ASSERT_TRUE(store.saveToFileSharded("test_compact_sharded.manifest", 3, false));
+    ASSERT_TRUE(NPCFactory::saveToFileSharded(store.materialize(), "test_object_sharded.manifest", 3, false));
+    EXPECT_EQ(readShards("test_compact_sharded.manifest"), readShards("test_object_sharded.manifest"));
+    EXPECT_EQ(NPCFactory::loadFromFileSharded("test_compact_sharded.manifest", false).size(), store.size());
+    for (const string manifest : {"test_compact_sharded.manifest", "test_object_sharded.manifest"}){
+        remove(manifest.c_str());
+        for (int i = 0; i < 3; i++){
+            remove((manifest + ".shard" + to_string(i)).c_str());
+        }
+    }
+}
+
+TEST(ShardedFileTest, DuplicatesAndValidation){
+    {
+        ofstream manifest("test_dup.manifest");
+        manifest << "NPC_SHARDS 2\ntest_dup.a\ntest_dup.b\n";
+        ofstream a("test_dup.a");
+        a << "SQUIRREL,Sq,100,100\nDRUID,Bad,0,100\n";
+        ofstream b("test_dup.b");
+        b << "WEREWOLF,Sq,200,200\nDRUID,Dru,300,300\n";
+    }
+    DungeonEditor editor;
+    EXPECT_TRUE(editor.loadFromFileSharded("test_dup.manifest"));
+    EXPECT_EQ(editor.getNPCCount(), 2);
+
+    remove("test_dup.b");
+    EXPECT_FALSE(editor.loadFromFileSharded("test_dup.manifest"));
+    EXPECT_EQ(editor.getNPCCount(), 2);
+    EXPECT_FALSE(editor.loadFromFileSharded("test_dup.a"));
+    remove("test_dup.manifest");
+    remove("test_dup.a");
+}
+
+TEST(BattleAnalyzerTest, MatchesRepeatedBattles){
+    WorkloadGenerator::Config config;
+    config.npcCount = 400;
+    config.seed = 3;
+    config.distribution = WorkloadGenerator::Distribution::CLUSTERED;
+    auto specs = WorkloadGenerator(config).generate();
+
+    vector<double> ranges = {0.5, 20.0, 2.0, 5.0, 10.0};
+    auto npcs = BattleHarness::buildNPCs(specs);
+    auto outcomes = BattleAnalyzer::analyze(npcs, ranges);
+    ASSERT_EQ(outcomes.size(), ranges.size());
+    for (const auto& npc : npcs){
+        EXPECT_TRUE(npc->isAlive());
+    }
+
+    for (size_t r = 0; r < ranges.size(); r++){
+        auto battle = BattleHarness::buildNPCs(specs);
+        BattleVisitor visitor(battle, ranges[r]);
+        visitor.executeBattle();
+
+        const auto& outcome = outcomes[r];
+        EXPECT_DOUBLE_EQ(outcome.range, ranges[r]);
+        EXPECT_EQ(outcome.survivors(), battle.size());
+        EXPECT_EQ(outcome.survivors() + outcome.killed.size(), specs.size());
+        size_t squirrels = 0, werewolves = 0, druids = 0;
+        for (const auto& npc : battle){
+            if (npc->getType() == "Squirrel") squirrels++;
+            if (npc->getType() == "Werewolf") werewolves++;
+            if (npc->getType() == "Druid") druids++;
+            EXPECT_EQ(find(outcome.killed.begin(), outcome.killed.end(), npc->getName()), outcome.killed.end());
+        }
+        EXPECT_EQ(outcome.squirrels, squirrels);
+        EXPECT_EQ(outcome.werewolves, werewolves);
+        EXPECT_EQ(outcome.druids, druids);
+    }
+    EXPECT_LE(outcomes[0].pairCount, outcomes[2].pairCount);
+    EXPECT_LE(outcomes[4].pairCount, outcomes[1].pairCount);
+}
+
+TEST(BattleAnalyzerTest, EditorAnalysisDoesNotMutate){
+    DungeonEditor editor;
+    editor.addNPC("squirrel", "Sq", 100, 100);
+    editor.addNPC("werewolf", "Wolf", 105, 100);
+    editor.addNPC("druid", "Dru", 130, 100);
+    auto outcomes = editor.analyzeBattle({1.0, 10.0, 50.0});
+    ASSERT_EQ(outcomes.size(), 3);
+    EXPECT_TRUE(outcomes[0].killed.empty());
+    EXPECT_EQ(outcomes[1].killed, vector<string>{"Wolf"});
+    EXPECT_EQ(outcomes[2].killed, (vector<string>{"Wolf", "Dru"}));
+    EXPECT_EQ(outcomes[2].pairCount, 3);
+    EXPECT_EQ(outcomes[2].squirrels, 1);
+    EXPECT_EQ(editor.getNPCCount(), 3);
+    EXPECT_TRUE(editor.analyzeBattle({}).empty());
+}
+
+TEST(BattleAnalyzerTest, CompactStoreMatchesMaterialized){
+    WorkloadGenerator::Config config;
+    config.npcCount = 400;
+    config.seed = 4;
+    config.distribution = WorkloadGenerator::Distribution::CLUSTERED;
+    CompactNPCStore store;
+    store.assign(BattleHarness::buildNPCs(WorkloadGenerator(config).generate()));
+    vector<double> ranges = {0.5, 2.0, 10.0};
+    auto packed = BattleAnalyzer::analyze(store, ranges);
+    auto objects = BattleAnalyzer::analyze(store.materialize(), ranges);
+    ASSERT_EQ(packed.size(), objects.size());
+    for (size_t r = 0; r < ranges.size(); r++){
+        EXPECT_EQ(packed[r].pairCount, objects[r].pairCount);
+        EXPECT_EQ(packed[r].killed, objects[r].killed);
+        EXPECT_EQ(packed[r].survivors(), objects[r].survivors());
+        EXPECT_EQ(packed[r].druids, objects[r].druids);
+    }
+    EXPECT_FALSE(packed[2].killed.empty());
+}
+
+TEST(ParallelBattleTest, BatchesHaveNoSharedNPC){
+    vector<shared_ptr<NPC>> npcs;
+    for (int i = 0; i < 6; i++){
+        npcs.push_back(make_shared<Squirrel>("Sq" + to_string(i), 10.0 + i, 10.0));
+    }
+    vector<pair<NPC*, NPC*>> pairs;
+    for (size_t i = 0; i < npcs.size(); i++){
+        for (size_t j = i + 1; j < npcs.size(); j++){
+            pairs.push_back({npcs[i].get(), npcs[j].get()});
+        }
+    }
+    auto batches = BattleVisitor::conflictFreeBatches(pairs);
+    vector<int> seen(pairs.size(), 0);
+    for (const auto& batch : batches){
+        set<NPC*> used;
+        for (size_t k : batch){
+            EXPECT_TRUE(used.insert(pairs[k].first).second);
+            EXPECT_TRUE(used.insert(pairs[k].second).second);
+            seen[k]++;
+        }
+    }
+    for (int count : seen){
+        EXPECT_EQ(count, 1);
+    }
+    EXPECT_TRUE(BattleVisitor::conflictFreeBatches({}).empty());
+}
+
+TEST(ParallelBattleTest, MatchesSequentialKillsAndEvents){
+    WorkloadGenerator::Config config;
+    config.npcCount = 800;
+    config.seed = 11;
+    config.distribution = WorkloadGenerator::Distribution::HOTSPOT;
+    auto specs = WorkloadGenerator(config).generate();
+
+    auto sequential = BattleHarness::buildNPCs(specs);
+    BattleLogger sequentialLogger;
+    RecordingObserver sequentialEvents;
+    sequentialLogger.attach(&sequentialEvents);
+    BattleVisitor(sequential, 4.0, &sequentialLogger).executeBattle();
+    ASSERT_FALSE(sequentialEvents.events.empty());
+
+    for (size_t threads : {2, 3, 8}) {
+        auto parallel = BattleHarness::buildNPCs(specs);
+        BattleLogger parallelLogger;
+        RecordingObserver parallelEvents;
+        parallelLogger.attach(&parallelEvents);
+        BattleVisitor(parallel, 4.0, &parallelLogger).executeBattleParallel(threads);
+        ASSERT_EQ(parallel.size(), sequential.size());
+        for (size_t i = 0; i < parallel.size(); i++){
+            EXPECT_EQ(parallel[i]->getName(), sequential[i]->getName());
+        }
+        EXPECT_EQ(parallelEvents.events, sequentialEvents.events);
+    }
+}
+
+TEST(ParallelBattleTest, EditorBattleThreads){
+    DungeonEditor editor;
+    editor.setBattleThreads(4);
+    editor.addNPC("squirrel", "Squirrel1", 100, 100);
+    editor.addNPC("werewolf", "Wolf1", 110, 110);
+    editor.addNPC("werewolf", "Wolf2", 400, 400);
+    editor.addNPC("druid", "Druid1", 105, 105);
+    editor.addNPC("druid", "Druid2", 200, 200);
+    editor.startBattle(50.0);
+    EXPECT_EQ(editor.getNPCCount(), 3);
+}
+
+TEST(SharedMemoryFeedTest, ChildProcessConsumesEvents){
+    string name = "/lab6_feed_test_" + to_string(getpid());
+    SharedMemoryLogger feed(name, 1024, 128);
+    ASSERT_TRUE(feed.isOpen());
+    BattleLogger logger;
+    logger.attach(&feed);
+
+    const int eventCount = 500;
+    int ready[2];
+    ASSERT_EQ(pipe(ready), 0);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Consumer process: a fresh reader over the named segment.
+        close(ready[0]);
+        SharedMemoryFeedReader reader(name, false);
+        char flag = reader.isOpen() ? 1 : 0;
+        if (write(ready[1], &flag, 1) != 1 || !flag) _exit(2);
+        close(ready[1]);
+        vector<FeedEvent> events;
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+        while (events.size() < eventCount && chrono::steady_clock::now() < deadline){
+            if (reader.poll(events) != 0) _exit(3);
+        }
+        if (events.size() != eventCount) _exit(4);
+        for (int i = 0; i < eventCount; i++){
+            if (events[i].sequence != static_cast<uint64_t>(i + 1)) _exit(5);
+            if (events[i].text != "event " + to_string(i)) _exit(6);
+        }
+        _exit(0);
+    }
+    close(ready[1]);
+    char flag = 0;
+    ASSERT_EQ(read(ready[0], &flag, 1), 1);
+    close(ready[0]);
+    ASSERT_EQ(flag, 1);
+    for (int i = 0; i < eventCount; i++){
+        logger.logBattleEvent("event " + to_string(i));
+    }
+    EXPECT_EQ(feed.getSequence(), eventCount);
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(SharedMemoryFeedTest, SlowReaderLosesOldestEvents){
+    string name = "/lab6_feed_overrun_" + to_string(getpid());
+    SharedMemoryLogger feed(name, 8, 64);
+    ASSERT_TRUE(feed.isOpen());
+    SharedMemoryFeedReader reader(name);
+    ASSERT_TRUE(reader.isOpen());
+    for (int i = 0; i < 20; i++){
+        feed.update("event " + to_string(i) + string(100, '.'));
+    }
+    vector<FeedEvent> events;
+    EXPECT_EQ(reader.poll(events), 12);
+    ASSERT_EQ(events.size(), 8);
+    EXPECT_EQ(events.front().sequence, 13);
+    EXPECT_EQ(events.back().text.rfind("event 19", 0), 0);
+    EXPECT_LT(events.back().text.size(), 64);
+    EXPECT_EQ(reader.poll(events), 0);
+    EXPECT_EQ(events.size(), 8);
+
+    SharedMemoryFeedReader missing("/lab6_feed_missing_" + to_string(getpid()));
+    EXPECT_FALSE(missing.isOpen());
+}
+
+TEST(SharedMemoryFeedTest, EditorPublishesBattleEvents){
+    string name = "/lab6_feed_editor_" + to_string(getpid());
+    DungeonEditor editor;
+    ASSERT_TRUE(editor.attachSharedMemoryLogger(name));
+    SharedMemoryFeedReader reader(name);
+    editor.addNPC("squirrel", "Sq", 100, 100);
+    editor.addNPC("werewolf", "Wolf", 101, 101);
+    editor.startBattle(10.0);
+    vector<FeedEvent> events;
+    EXPECT_EQ(reader.poll(events), 0);
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].text, "Sq (Squirrel) killed Wolf (Werewolf)");
+    EXPECT_GT(editor.getMemoryUsage().loggers, 1024);
+}
+
+TEST(SharedMemoryFeedTest, ReattachingSameNameKeepsFeed){
+    string name = "/lab6_feed_reattach_" + to_string(getpid());
+    DungeonEditor editor;
+    ASSERT_TRUE(editor.attachSharedMemoryLogger(name));
+    ASSERT_TRUE(editor.attachSharedMemoryLogger(name));
+    SharedMemoryFeedReader reader(name);
+    ASSERT_TRUE(reader.isOpen());
+    editor.addNPC("squirrel", "Sq", 100, 100);
+    editor.addNPC("druid", "Dru", 101, 101);
+    editor.startBattle(10.0);
+    vector<FeedEvent> events;
+    EXPECT_EQ(reader.poll(events), 0);
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].text, "Sq (Squirrel) killed Dru (Druid)");
+}
+
+TEST(SharedMemoryFeedTest, StaleFeedOfDeadWriterIsReplaced){
+    string name = "/lab6_feed_stale_" + to_string(getpid());
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Dies without running the destructor, like a killed writer.
+        SharedMemoryLogger feed(name, 8, 64);
+        feed.update("orphaned");
+        _exit(feed.isOpen() ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    {
+        SharedMemoryFeedReader stale(name);
+        ASSERT_TRUE(stale.isOpen());
+    }
+
+    SharedMemoryLogger feed(name, 8, 64);
+    ASSERT_TRUE(feed.isOpen());
+    feed.update("fresh");
+    SharedMemoryFeedReader reader(name);
+    vector<FeedEvent> events;
+    EXPECT_EQ(reader.poll(events), 0);
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].text, "fresh");
+}
+
+TEST(SharedMemoryFeedTest, SecondWriterCannotTakeOverFeed){
+    string name = "/lab6_feed_exclusive_" + to_string(getpid());
+    SharedMemoryLogger first(name, 8, 64);
+    ASSERT_TRUE(first.isOpen());
+    first.update("before");
+    {
+        SharedMemoryLogger second(name, 16, 128);
+        EXPECT_FALSE(second.isOpen());
+    }
+    first.update("after");
+    SharedMemoryFeedReader reader(name);
+    ASSERT_TRUE(reader.isOpen());
+    vector<FeedEvent> events;
+    EXPECT_EQ(reader.poll(events), 0);
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0].text, "before");
+    EXPECT_EQ(events[1].text, "after");
+    EXPECT_EQ(first.getSequence(), 2);
+}
+
+TEST(TiledWorldTest, CrossTileBattleMatchesGlobalBattle){
+    string directory = "test_world_" + to_string(getpid());
+    WorkloadGenerator::Config config;
+    config.npcCount = 600;
+    config.seed = 5;
+    auto specs = WorkloadGenerator(config).generate();
+
+    // Spread the generated dungeon over a 3x2 world and pull everything
+    // towards the tile borders so many pairs straddle them.
+    vector<shared_ptr<NPC>> reference;
+    {
+        TiledWorld world(directory, 3, 2, 2);
+        for (size_t i = 0; i < specs.size(); i++){
+            double x = (i % 3) * 500.0 + (specs[i].x < 250 ? specs[i].x / 50 + 0.01 : 500 - specs[i].x / 50);
+            double y = (i % 2) * 500.0 + specs[i].y;
+            ASSERT_TRUE(world.addNPC(NPCFactory::typeToString(specs[i].type), specs[i].name, x, y));
+            switch (specs[i].type){
+                case NPCFactory::NPCType::SQUIRREL: reference.push_back(make_shared<Squirrel>(specs[i].name, x, y)); break;
+                case NPCFactory::NPCType::WEREWOLF: reference.push_back(make_shared<Werewolf>(specs[i].name, x, y)); break;
+                case NPCFactory::NPCType::DRUID: reference.push_back(make_shared<Druid>(specs[i].name, x, y)); break;
+            }
+        }
+        EXPECT_LE(world.getResidentTileCount(), 2);
+        EXPECT_FALSE(world.addNPC("druid", "Outside", 1501, 10));
+    }
+
+    TiledWorld world(directory, 3, 2, 2);
+    EXPECT_EQ(world.getResidentTileCount(), 0);
+    EXPECT_EQ(world.getNPCCount(), specs.size());
+    size_t killed = world.startBattle(8.0);
+    BattleVisitor(reference, 8.0).executeBattle();
+    EXPECT_GT(killed, 0);
+    EXPECT_EQ(world.getNPCCount(), reference.size());
+    EXPECT_EQ(killed, specs.size() - reference.size());
+    EXPECT_LE(world.getResidentTileCount(), 2);
+
+    set<string> expected, actual;
+    for (const auto& npc : reference){
+        expected.insert(npc->getName());
+    }
+    for (size_t ty = 0; ty < 2; ty++){
+        for (size_t tx = 0; tx < 3; tx++){
+            DungeonEditor& tile = world.tile(tx, ty);
+            ASSERT_FALSE(tile.isCompactMode());
+            string listing = directory + "/listing.txt";
+            tile.saveToFile(listing);
+            ifstream file(listing);
+            string line;
+            while (getline(file, line)){
+                stringstream ss(line);
+                string type, name;
+                getline(ss, type, ',');
+                getline(ss, name, ',');
+                actual.insert(name);
+            }
+        }
+    }
+    EXPECT_EQ(actual, expected);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(TiledWorldTest, ActiveTilesAndSingleTileEditor){
+    string directory = "test_world_active_" + to_string(getpid());
+    {
+        TiledWorld world(directory, 4, 4, 3);
+        DungeonEditor& origin = world.tile(0, 0);
+        EXPECT_TRUE(origin.addNPC("squirrel", "Sq", 499, 100));
+        EXPECT_FALSE(origin.addNPC("squirrel", "TooFar", 501, 100));
+        EXPECT_TRUE(world.addNPC("werewolf", "Wolf", 503, 100));
+        EXPECT_TRUE(world.addNPC("druid", "FarDru", 1900, 1900));
+        EXPECT_TRUE(world.addNPC("werewolf", "FarWolf", 1901, 1900));
+        EXPECT_EQ(world.getTileNPCCount(1, 0), 1);
+
+        // Only tile (3,3) is active: the border pair at x=500 is untouched.
+        EXPECT_EQ(world.startBattle(10.0, {{3, 3}}), 1);
+        EXPECT_EQ(world.getNPCCount(), 3);
+        // The squirrel's tile is active and reaches into the inactive one.
+        EXPECT_EQ(world.startBattle(10.0, {{0, 0}}), 1);
+        EXPECT_EQ(world.getTileNPCCount(1, 0), 0);
+        EXPECT_EQ(world.getNPCCount(), 2);
+        EXPECT_TRUE(world.flush());
+    }
+    TiledWorld reopened(directory, 4, 4, 3);
+    EXPECT_EQ(reopened.getNPCCount(), 2);
+    EXPECT_EQ(reopened.getTileNPCCount(3, 3), 1);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(TiledWorldTest, CompactTileStaysCompactThroughBattle){
+    string directory = "test_world_compact_" + to_string(getpid());
+    {
+        TiledWorld world(directory, 2, 1);
+        EXPECT_TRUE(world.addNPC("squirrel", "Sq", 498, 100));
+        EXPECT_TRUE(world.addNPC("druid", "Dru", 400, 100));
+        EXPECT_TRUE(world.addNPC("werewolf", "Wolf", 502, 100));
+        EXPECT_TRUE(world.addNPC("druid", "FarDru", 900, 400));
+        world.tile(0, 0).setCompactMode(true);
+        world.tile(1, 0).setCompactMode(true);
+        RecordingObserver recorder;
+        world.getBattleLogger().attach(&recorder);
+        EXPECT_EQ(world.startBattle(10.0), 1);
+        world.getBattleLogger().detach(&recorder);
+        EXPECT_EQ(recorder.events, vector<string>{"Sq (Squirrel) killed Wolf (Werewolf)"});
+
+        EXPECT_TRUE(world.tile(0, 0).isCompactMode());
+        EXPECT_TRUE(world.tile(1, 0).isCompactMode());
+        EXPECT_EQ(world.getTileNPCCount(0, 0), 2);
+        EXPECT_EQ(world.getTileNPCCount(1, 0), 1);
+        EXPECT_EQ(world.tile(1, 0).getNPCNames(), vector<string>{"FarDru"});
+    }
+    TiledWorld reopened(directory, 2, 1);
+    EXPECT_EQ(reopened.getNPCCount(), 3);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(TiledWorldTest, DamagedSnapshotIsNeverWrittenBack){
+    string directory = "test_world_damaged_" + to_string(getpid());
+    {
+        TiledWorld world(directory, 2, 1);
+        for (int i = 0; i < 10; i++){
+            EXPECT_TRUE(world.addNPC("druid", "Dru" + to_string(i), 10 + i * 40, 100));
+        }
+        EXPECT_TRUE(world.flush());
+    }
+    string path = (std::filesystem::path(directory) / "tile_0_0.bin").string();
+    auto readFile = [&path](){
+        ifstream file(path, ios::binary);
+        return string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    };
+    // 24-byte header, 32-byte records, type byte at offset 24 of a record.
+    auto corrupt = [&](size_t offset){
+        fstream file(path, ios::binary | ios::in | ios::out);
+        file.seekp(static_cast<streamoff>(offset));
+        file.put(static_cast<char>(0x7F));
+    };
+
+    corrupt(24 + 9 * 32 + 24);
+    string damaged = readFile();
+    {
+        TiledWorld world(directory, 2, 1, 1);
+        EXPECT_EQ(world.getTileNPCCount(0, 0), 10);
+        EXPECT_EQ(world.tile(0, 0).getNPCCount(), 0);
+        EXPECT_FALSE(world.addNPC("squirrel", "Late", 20, 20));
+        EXPECT_EQ(world.startBattle(100.0), 0);
+        EXPECT_FALSE(world.flush());
+        EXPECT_EQ(readFile(), damaged);
+        // Only one tile fits, so loading (1,0) evicts the damaged tile.
+        world.tile(1, 0);
+        EXPECT_EQ(world.getResidentTileCount(), 1);
+        EXPECT_EQ(readFile(), damaged);
+    }
+    EXPECT_EQ(readFile(), damaged);
+
+    corrupt(0);
+    damaged = readFile();
+    {
+        TiledWorld world(directory, 2, 1, 1);
+        EXPECT_EQ(world.tile(0, 0).getNPCCount(), 0);
+        world.tile(1, 0);
+        EXPECT_EQ(readFile(), damaged);
+    }
+    EXPECT_EQ(readFile(), damaged);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ListingTest, RenderMatchesStreamFormatting){
+    DungeonEditor editor;
+    editor.setQuiet(true);
+    editor.addNPC("squirrel", "Sq", 0.00001, 123.456789);
+    editor.addNPC("druid", "A_very_long_druid_name_here", 500, 0.1);
+    editor.addNPC("werewolf", "Wolf", 250.5, 33);
+
+    ostringstream expected;
+    expected << "\n=== NPC List ===" << endl;
+    expected << left << setw(15) << "Type" << setw(20) << "Name" << setw(10) << "X" << setw(10) << "Y" << "Status" << endl;
+    expected << string(60, '-') << endl;
+    expected << left << setw(15) << "Squirrel" << setw(20) << "Sq" << setw(10) << 0.00001 << setw(10) << 123.456789 << "Alive" << endl;
+    expected << left << setw(15) << "Druid" << setw(20) << "A_very_long_druid_name_here" << setw(10) << 500.0 << setw(10) << 0.1 << "Alive" << endl;
+    expected << left << setw(15) << "Werewolf" << setw(20) << "Wolf" << setw(10) << 250.5 << setw(10) << 33.0 << "Alive" << endl;
+    expected << "Total: 3 NPCs" << endl;
+    EXPECT_EQ(editor.renderNPCTable(), expected.str());
+
+    editor.setCompactMode(true);
+    EXPECT_NE(editor.renderNPCTable().find("Total: 3 NPCs"), string::npos);
+}
+
+TEST(ListingTest, FiltersAndPaging){
+    DungeonEditor editor;
+    editor.setQuiet(true);
+    for (int i = 1; i <= 30; i++){
+        editor.addNPC(i % 3 == 0 ? "druid" : "squirrel", "N" + to_string(i), i * 10.0, i * 10.0);
+    }
+    NPCListOptions druids;
+    druids.type = NPCFactory::NPCType::DRUID;
+    string table = editor.renderNPCTable(druids);
+    EXPECT_NE(table.find("Shown: 10 of 10 matching"), string::npos);
+    EXPECT_EQ(table.find("Squirrel"), string::npos);
+
+    NPCListOptions page;
+    page.offset = 5;
+    page.limit = 4;
+    table = editor.renderNPCTable(page);
+    EXPECT_NE(table.find("N6 "), string::npos);
+    EXPECT_NE(table.find("N9 "), string::npos);
+    EXPECT_EQ(table.find("N5 "), string::npos);
+    EXPECT_EQ(table.find("N10 "), string::npos);
+    EXPECT_NE(table.find("Shown: 4 of 30 matching"), string::npos);
+
+    NPCListOptions region;
+    region.minX = 100;
+    region.maxX = 150;
+    region.alive = true;
+    EXPECT_NE(editor.renderNPCTable(region).find("Shown: 6 of 6 matching"), string::npos);
+    region.alive = false;
+    EXPECT_NE(editor.renderNPCTable(region).find("Shown: 0 of 0 matching"), string::npos);
+}
+
+TEST(ListingTest, QuietModeWritesNothing){
+    ostringstream captured;
+    streambuf* saved = cout.rdbuf(captured.rdbuf());
+    {
+        DungeonEditor editor;
+        editor.setQuiet(true);
+        editor.addNPC("squirrel", "Sq", 100, 100);
+        editor.addNPC("werewolf", "Wolf", 101, 101);
+        editor.saveToFile("test_quiet.txt");
+        editor.loadFromFile("test_quiet.txt");
+        editor.startBattle(10.0);
+        editor.clearAll();
+        EXPECT_TRUE(editor.isQuiet());
+    }
+    string quietOutput = captured.str();
+    {
+        DungeonEditor editor;
+        editor.setQuiet(true);
+        editor.setQuiet(false);
+        editor.addNPC("squirrel", "Sq", 100, 100);
+        editor.addNPC("werewolf", "Wolf", 101, 101);
+        editor.startBattle(10.0);
+    }
+    cout.rdbuf(saved);
+    remove("test_quiet.txt");
+    EXPECT_TRUE(quietOutput.empty());
+    string loudOutput = captured.str();
+    EXPECT_NE(loudOutput.find("Added"), string::npos);
+    EXPECT_NE(loudOutput.find("killed"), string::npos);
+    EXPECT_EQ(loudOutput.find("killed"), loudOutput.rfind("killed"));
+}
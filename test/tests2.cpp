@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "../include/battle_harness.h"
+#include "../include/workload.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+void expectAllEnginesMatch(const WorkloadGenerator::Config& config, double range){
+    auto specs = BattleHarness::generate(config);
+    for (const auto& comparison : BattleHarness::compare(specs, range, BattleHarness::defaultEngines(4))){
+        EXPECT_TRUE(comparison.matches())
+            << comparison.name << " seed " << config.seed
+            << " " << WorkloadGenerator::distributionToString(config.distribution)
+            << " range " << range << ": " << comparison.mismatch;
+    }
+}
+
+}
+
+TEST(DifferentialTest, SeededDungeonsAllDistributions){
+    for (auto distribution : {WorkloadGenerator::Distribution::UNIFORM,
+                              WorkloadGenerator::Distribution::CLUSTERED,
+                              WorkloadGenerator::Distribution::HOTSPOT}) {
+        for (uint64_t seed = 1; seed <= 3; seed++){
+            WorkloadGenerator::Config config;
+            config.npcCount = 500;
+            config.seed = seed;
+            config.distribution = distribution;
+            for (double range : {1.0, 6.0, 25.0}){
+                expectAllEnginesMatch(config, range);
+            }
+        }
+    }
+}
+
+TEST(DifferentialTest, LargeDenseDungeon){
+    WorkloadGenerator::Config config;
+    config.npcCount = 3000;
+    config.seed = 2024;
+    config.distribution = WorkloadGenerator::Distribution::HOTSPOT;
+    config.squirrelWeight = 1.0;
+    config.werewolfWeight = 2.0;
+    config.druidWeight = 3.0;
+    expectAllEnginesMatch(config, 3.0);
+}
+
+TEST(DifferentialTest, RawCoordinatesExposeCompactQuantisation){
+    WorkloadGenerator::Config config;
+    config.npcCount = 500;
+    config.seed = 3;
+    config.distribution = WorkloadGenerator::Distribution::CLUSTERED;
+    auto specs = BattleHarness::generate(config);
+    BattleEngine compact = BattleHarness::defaultEngines(2)[1];
+    ASSERT_EQ(compact.name, "compact");
+    EXPECT_GT(compact.tolerance, 0.0);
+
+    // On raw coordinates a pair on the range boundary flips: compact is not
+    // exact, but stays within its stated tolerance.
+    BattleEngine exact = compact;
+    exact.tolerance = 0.0;
+    auto comparisons = BattleHarness::compare(specs, 1.0, {compact, exact});
+    EXPECT_TRUE(comparisons[0].matches()) << comparisons[0].mismatch;
+    EXPECT_GT(comparisons[0].survivorsDiffering, 0);
+    EXPECT_FALSE(comparisons[1].matches());
+
+    // Snapped to the compact grid, compact is exact again.
+    auto snapped = BattleHarness::snapToCompactGrid(specs);
+    EXPECT_TRUE(BattleHarness::compare(snapped, 1.0, {exact})[0].matches());
+}
+
+TEST(DifferentialTest, LossyEngineOutsideToleranceIsCaught){
+    WorkloadGenerator::Config config;
+    config.npcCount = 300;
+    config.distribution = WorkloadGenerator::Distribution::CLUSTERED;
+    auto specs = BattleHarness::generate(config);
+    BattleEngine tooFar{"too-far", true, true, [](const vector<NPCSpec>& specs, double range){
+        return BattleHarness::runReference(specs, range + 2.0);
+    }, 0.05};
+    auto comparison = BattleHarness::compare(specs, 3.0, {tooFar})[0];
+    EXPECT_FALSE(comparison.matches());
+    EXPECT_FALSE(comparison.mismatch.empty());
+}
+
+TEST(DifferentialTest, DetectsDivergingEngine){
+    WorkloadGenerator::Config config;
+    config.npcCount = 200;
+    config.distribution = WorkloadGenerator::Distribution::CLUSTERED;
+    auto specs = BattleHarness::generate(config);
+
+    BattleEngine noKills{"no-kills", true, true, [](const vector<NPCSpec>& specs, double){
+        BattleRun run;
+        for (const auto& spec : specs){
+            run.survivors.push_back(spec.name);
+        }
+        return run;
+    }};
+    BattleEngine reordered{"reordered-events", true, true, [](const vector<NPCSpec>& specs, double range){
+        BattleRun run = BattleHarness::runReference(specs, range);
+        swap(run.events.front(), run.events.back());
+        return run;
+    }};
+    auto comparisons = BattleHarness::compare(specs, 20.0, {noKills, reordered});
+    ASSERT_EQ(comparisons.size(), 2);
+    EXPECT_FALSE(comparisons[0].survivorsMatch);
+    EXPECT_FALSE(comparisons[0].mismatch.empty());
+    EXPECT_TRUE(comparisons[1].survivorsMatch);
+    EXPECT_FALSE(comparisons[1].eventsMatch);
+}
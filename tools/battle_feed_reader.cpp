@@ -0,0 +1,82 @@
+#include <chrono>
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/shm_feed.h"
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int){
+    stopRequested = 1;
+}
+
+void printUsage(const char* program){
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --name NAME       shared memory feed name (default /npc_battle_feed)\n"
+              << "  --new             skip events already in the ring\n"
+              << "  --count N         exit after N events (default: run until interrupted)\n"
+              << "  --idle-ms MS      sleep between empty polls (default 10)\n";
+}
+
+}
+
+int main(int argc, char** argv){
+    std::string name = "/npc_battle_feed";
+    bool fromOldest = true;
+    size_t count = 0;
+    int idleMs = 10;
+    for (int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--new") {
+            fromOldest = false;
+        } else if (i + 1 < argc && arg == "--name") {
+            name = argv[++i];
+        } else if (i + 1 < argc && arg == "--count") {
+            count = std::stoull(argv[++i]);
+        } else if (i + 1 < argc && arg == "--idle-ms") {
+            idleMs = std::stoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    SharedMemoryFeedReader reader(name, fromOldest);
+    if (!reader.isOpen()) return 1;
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    size_t received = 0;
+    size_t lost = 0;
+    std::vector<FeedEvent> events;
+    while (!stopRequested && (count == 0 || received < count)){
+        events.clear();
+        size_t newlyLost = reader.poll(events, count == 0 ? SIZE_MAX : count - received);
+        if (newlyLost > 0) {
+            lost += newlyLost;
+            std::cerr << "Warning: " << newlyLost << " events overwritten before they were read" << std::endl;
+        }
+        if (events.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(idleMs));
+            continue;
+        }
+        for (const auto& event : events){
+            std::time_t seconds = static_cast<std::time_t>(event.timestampNs / 1000000000);
+            char buffer[80];
+            std::strftime(buffer, sizeof(buffer), "[%Y-%m-%d %H:%M:%S]", std::localtime(&seconds));
+            std::cout << "#" << event.sequence << " " << buffer << " " << event.text << "\n";
+        }
+        std::cout.flush();
+        received += events.size();
+    }
+    std::cerr << "Received " << received << " events, lost " << lost << std::endl;
+    return 0;
+}